@@ -0,0 +1,256 @@
+#include "Benchmark.h"
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+#include "helpers.h"
+
+void BenchmarkRecorder::create(int frameCount)
+{
+	frames.assign(frameCount, FrameTiming());
+	for (int i = 0; i < frameCount; i++)
+	{
+		frames[i].frame = i;
+	}
+	glGenQueries(queryCount, queries);
+	for (int i = 0; i < queryCount; i++)
+	{
+		queryFrames[i] = -1;
+	}
+	currentFrame = -1;
+}
+
+void BenchmarkRecorder::beginFrame(int frame)
+{
+	currentFrame = frame;
+	int slot = frame % queryCount;
+	// This query was last used queryCount frames ago, so its result should be ready by now.
+	collect(slot);
+	queryFrames[slot] = frame;
+	glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+	cpuStart = std::chrono::high_resolution_clock::now();
+}
+
+void BenchmarkRecorder::endFrame(const GLStateCache::Counters& stateCalls, const CullStats& culling)
+{
+	auto cpuEnd = std::chrono::high_resolution_clock::now();
+	glEndQuery(GL_TIME_ELAPSED);
+	if (currentFrame >= 0 && currentFrame < (int)frames.size())
+	{
+		frames[currentFrame].cpuMs = std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count();
+		frames[currentFrame].stateCallsIssued = stateCalls.issued;
+		frames[currentFrame].stateCallsSkipped = stateCalls.skipped;
+		frames[currentFrame].visible = culling.visible;
+		frames[currentFrame].culled = culling.culled;
+	}
+}
+
+// Reads back the queries still in flight after the last frame.
+void BenchmarkRecorder::finish()
+{
+	for (int i = 0; i < queryCount; i++)
+	{
+		collect(i);
+	}
+}
+
+void BenchmarkRecorder::collect(int slot)
+{
+	int frame = queryFrames[slot];
+	if (frame < 0) return;
+
+	GLuint64 elapsedNs = 0;
+	glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &elapsedNs);
+	if (frame < (int)frames.size())
+	{
+		frames[frame].gpuMs = elapsedNs / 1000000.0;
+	}
+	queryFrames[slot] = -1;
+}
+
+// A path ending in .json gets JSON, anything else gets CSV.
+bool BenchmarkRecorder::write(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "Could not open benchmark output " << path << '\n';
+		return false;
+	}
+
+	bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+	if (json)
+	{
+		file << "{\n  \"frames\": [\n";
+		for (size_t i = 0; i < frames.size(); i++)
+		{
+			file << "    { \"frame\": " << frames[i].frame << ", \"cpuMs\": " << frames[i].cpuMs << ", \"gpuMs\": " << frames[i].gpuMs
+				<< ", \"stateCallsIssued\": " << frames[i].stateCallsIssued << ", \"stateCallsSkipped\": " << frames[i].stateCallsSkipped
+				<< ", \"visible\": " << frames[i].visible << ", \"culled\": " << frames[i].culled << " }";
+			file << (i + 1 < frames.size() ? ",\n" : "\n");
+		}
+		file << "  ]\n}\n";
+	}
+	else
+	{
+		file << "frame,cpuMs,gpuMs,stateCallsIssued,stateCallsSkipped,visible,culled\n";
+		for (const FrameTiming& timing : frames)
+		{
+			file << timing.frame << ',' << timing.cpuMs << ',' << timing.gpuMs << ',' << timing.stateCallsIssued << ',' << timing.stateCallsSkipped << ',' << timing.visible << ',' << timing.culled << '\n';
+		}
+	}
+
+	std::cout << "Wrote " << frames.size() << " frame timings to " << path << '\n';
+	return true;
+}
+
+void BenchmarkRecorder::printSummary() const
+{
+	if (frames.empty()) return;
+
+	double cpuTotal = 0.0;
+	double gpuTotal = 0.0;
+	double issuedTotal = 0.0;
+	double skippedTotal = 0.0;
+	double visibleTotal = 0.0;
+	double culledTotal = 0.0;
+	for (const FrameTiming& timing : frames)
+	{
+		cpuTotal += timing.cpuMs;
+		gpuTotal += timing.gpuMs;
+		issuedTotal += timing.stateCallsIssued;
+		skippedTotal += timing.stateCallsSkipped;
+		visibleTotal += timing.visible;
+		culledTotal += timing.culled;
+	}
+	std::cout << "Average over " << frames.size() << " frames: CPU " << cpuTotal / frames.size() << " ms, GPU " << gpuTotal / frames.size() << " ms, "
+		<< issuedTotal / frames.size() << " state calls issued, " << skippedTotal / frames.size() << " skipped, "
+		<< visibleTotal / frames.size() << " objects visible, " << culledTotal / frames.size() << " culled\n";
+}
+
+void BenchmarkRecorder::destroy()
+{
+	glDeleteQueries(queryCount, queries);
+	for (int i = 0; i < queryCount; i++)
+	{
+		queries[i] = 0;
+		queryFrames[i] = -1;
+	}
+}
+
+namespace
+{
+	float largestDifference(const std::vector<glm::mat4>& a, const std::vector<glm::mat4>& b)
+	{
+		float largest = 0.f;
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				glm::vec4 difference = glm::abs(a[i][column] - b[i][column]);
+				largest = glm::max(largest, glm::max(glm::max(difference.x, difference.y), glm::max(difference.z, difference.w)));
+			}
+		}
+		return largest;
+	}
+}
+
+void runTransformBenchmark(size_t count)
+{
+	// A fixed seed, so every run composes the same matrices.
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-100.f, 100.f);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	std::uniform_real_distribution<float> angle(-20.f, 20.f);
+	std::uniform_real_distribution<float> scale(0.1f, 4.f);
+	std::vector<glm::vec3> translations(count);
+	std::vector<glm::vec3> axes(count);
+	std::vector<float> angles(count);
+	std::vector<glm::vec3> scales(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		translations[i] = glm::vec3(position(random), position(random), position(random));
+		axes[i] = glm::vec3(unit(random), unit(random), unit(random) + 1.5f);
+		angles[i] = angle(random);
+		scales[i] = glm::vec3(scale(random), scale(random), scale(random));
+	}
+
+	std::vector<glm::mat4> perCall(count);
+	std::vector<glm::mat4> batched(count);
+	const int repeats = 10;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < repeats; repeat++)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			perCall[i] = trs(translations[i], axes[i], angles[i], scales[i]);
+		}
+	}
+	auto middle = std::chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < repeats; repeat++)
+	{
+		trsBatch(translations.data(), axes.data(), angles.data(), scales.data(), batched.data(), count);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	const float maxError = largestDifference(perCall, batched);
+
+	// The batch reduces angles to [-pi, pi] itself, so check it again on angles far outside that. Without rotations the
+	// difference would be swamped by the translations, so those are left at zero here.
+	std::uniform_real_distribution<float> largeAngle(-10000.f, 10000.f);
+	for (size_t i = 0; i < count; i++)
+	{
+		angles[i] = largeAngle(random);
+		perCall[i] = trs(glm::vec3(0.f), axes[i], angles[i], 1.f);
+	}
+	std::vector<glm::vec3> origins(count, glm::vec3(0.f));
+	trBatch(origins.data(), axes.data(), angles.data(), batched.data(), count);
+	const float maxLargeAngleError = largestDifference(perCall, batched);
+
+	double perCallMs = std::chrono::duration<double, std::milli>(middle - start).count() / repeats;
+	double batchedMs = std::chrono::duration<double, std::milli>(end - middle).count() / repeats;
+	std::cout << "Composing " << count << " matrices: trs() " << perCallMs << " ms, trsBatch() " << batchedMs << " ms ("
+		<< perCallMs / batchedMs << "x), largest difference " << maxError << ", " << maxLargeAngleError
+		<< " with angles up to 10000 radians\n";
+}
+
+void runCullBenchmark(size_t count)
+{
+	// The target from the culling work is a million spheres well under a millisecond, so the budget is half of one, scaled linearly to count.
+	const double budgetMsPerMillion = 0.5;
+
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-100.f, 100.f);
+	std::uniform_real_distribution<float> radius(0.5f, 2.f);
+	SphereSet spheres;
+	spheres.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		spheres.set(i, glm::vec3(position(random), position(random), position(random)), radius(random));
+	}
+	spheres.build(); // Done once when the spheres are set up, so it isn't part of the timing.
+	const glm::mat4 proj = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f);
+	const glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+	const Frustum frustum = extractFrustum(proj * view);
+
+	std::vector<uint32_t> visible;
+	visible.reserve(count);
+	CullStats stats = cullSpheres(frustum, spheres, visible); // Warms the caches and sizes visible, so neither is timed.
+	const int repeats = 20;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < repeats; repeat++)
+	{
+		stats = cullSpheres(frustum, spheres, visible);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	const double ms = std::chrono::duration<double, std::milli>(end - start).count() / repeats;
+	const double budgetMs = budgetMsPerMillion * count / 1000000.0;
+	std::cout << "Culling " << count << " spheres: " << ms << " ms, " << stats.visible << " visible, " << stats.culled << " culled. "
+		<< (ms <= budgetMs ? "Within" : "Missed") << " the " << budgetMs << " ms budget (" << budgetMsPerMillion << " ms per million)";
+	if (ms > budgetMs)
+	{
+		std::cout << " by " << ms - budgetMs << " ms, " << ms / budgetMs << "x over";
+	}
+	std::cout << '\n';
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "GLState.h"
+#include "FrustumCuller.h"
+
+// Records how long each benchmark frame took on the CPU and on the GPU, then writes the numbers out as CSV or JSON.
+// GPU time comes from GL_TIME_ELAPSED queries. They're kept in a small ring and read back a few frames late so we never wait on the GPU.
+class BenchmarkRecorder
+{
+public:
+	BenchmarkRecorder() = default;
+
+	void create(int frameCount);
+	void beginFrame(int frame);
+	// Takes this frame's state cache and culling counters along with the timings, so the savings show up per frame.
+	void endFrame(const GLStateCache::Counters& stateCalls, const CullStats& culling);
+	void finish();
+	bool write(const std::string& path) const;
+	void printSummary() const;
+	void destroy();
+
+private:
+	struct FrameTiming
+	{
+		int frame = 0;
+		double cpuMs = 0.0;
+		double gpuMs = 0.0;
+		unsigned int stateCallsIssued = 0;
+		unsigned int stateCallsSkipped = 0;
+		unsigned int visible = 0;
+		unsigned int culled = 0;
+	};
+
+	static const int queryCount = 4;
+
+	void collect(int slot);
+
+	std::vector<FrameTiming> frames;
+	GLuint queries[queryCount] = {};
+	int queryFrames[queryCount] = {};
+	int currentFrame = -1;
+	std::chrono::high_resolution_clock::time_point cpuStart;
+};
+
+// Times building count matrices through trs() one call at a time against trsBatch(), and prints both along with the largest difference.
+// CPU only, no context needed.
+void runTransformBenchmark(size_t count);
+// Times cullSpheres() on count spheres scattered around a camera and checks it against the culling budget of 0.5 ms per million spheres.
+// Prints whether the budget was met, not just the time. CPU only, no context needed.
+void runCullBenchmark(size_t count);
@@ -0,0 +1,343 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	struct Color565
+	{
+		uint16_t packed;
+		float rgb[3]; // What the GPU decodes packed back into, 0 to 255.
+	};
+
+	Color565 quantize565(const float* rgb)
+	{
+		const int r = (int)std::min(std::max(rgb[0], 0.f), 255.f) * 31 / 255;
+		const int g = (int)std::min(std::max(rgb[1], 0.f), 255.f) * 63 / 255;
+		const int b = (int)std::min(std::max(rgb[2], 0.f), 255.f) * 31 / 255;
+		// Truncating above can land one step low, so also try the next step up and keep whichever decodes closer.
+		const int channels[3] = { r, g, b };
+		const int maxima[3] = { 31, 63, 31 };
+		int best[3];
+		for (int c = 0; c < 3; c++)
+		{
+			best[c] = channels[c];
+			const int up = std::min(channels[c] + 1, maxima[c]);
+			const float low = c == 1 ? (float)((channels[c] << 2) | (channels[c] >> 4)) : (float)((channels[c] << 3) | (channels[c] >> 2));
+			const float high = c == 1 ? (float)((up << 2) | (up >> 4)) : (float)((up << 3) | (up >> 2));
+			if (std::fabs(high - rgb[c]) < std::fabs(low - rgb[c])) best[c] = up;
+		}
+
+		Color565 color;
+		color.packed = (uint16_t)((best[0] << 11) | (best[1] << 5) | best[2]);
+		color.rgb[0] = (float)((best[0] << 3) | (best[0] >> 2));
+		color.rgb[1] = (float)((best[1] << 2) | (best[1] >> 4));
+		color.rgb[2] = (float)((best[2] << 3) | (best[2] >> 2));
+		return color;
+	}
+
+	// Copies out the 4x4 block at (blockX, blockY) as RGBA, repeating the last row and column for blocks that hang off the edge.
+	void fetchBlock(const unsigned char* pixels, uint32_t width, uint32_t height, int channels, uint32_t blockX, uint32_t blockY, unsigned char block[16][4])
+	{
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			const uint32_t sy = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; x++)
+			{
+				const uint32_t sx = std::min(blockX * 4 + x, width - 1);
+				const unsigned char* texel = pixels + ((size_t)sy * width + sx) * channels;
+				unsigned char* dst = block[y * 4 + x];
+				switch (channels)
+				{
+				case 1: dst[0] = dst[1] = dst[2] = texel[0]; dst[3] = 255; break;
+				case 2: dst[0] = dst[1] = dst[2] = texel[0]; dst[3] = texel[1]; break;
+				case 3: dst[0] = texel[0]; dst[1] = texel[1]; dst[2] = texel[2]; dst[3] = 255; break;
+				default: memcpy(dst, texel, 4); break;
+				}
+			}
+		}
+	}
+
+	// Picks the closest of the four palette entries for every texel. Returns the total squared error.
+	float assignIndices(const unsigned char block[16][4], const Color565& c0, const Color565& c1, int indices[16])
+	{
+		float palette[4][3];
+		for (int c = 0; c < 3; c++)
+		{
+			palette[0][c] = c0.rgb[c];
+			palette[1][c] = c1.rgb[c];
+			palette[2][c] = (2.f * c0.rgb[c] + c1.rgb[c]) / 3.f;
+			palette[3][c] = (c0.rgb[c] + 2.f * c1.rgb[c]) / 3.f;
+		}
+		float total = 0.f;
+		for (int i = 0; i < 16; i++)
+		{
+			float bestError = 1e30f;
+			for (int p = 0; p < 4; p++)
+			{
+				const float dr = block[i][0] - palette[p][0];
+				const float dg = block[i][1] - palette[p][1];
+				const float db = block[i][2] - palette[p][2];
+				const float error = dr * dr + dg * dg + db * db;
+				if (error < bestError)
+				{
+					bestError = error;
+					indices[i] = p;
+				}
+			}
+			total += bestError;
+		}
+		return total;
+	}
+
+	// Fits the endpoints to the line through the block's colours (the principal axis of their covariance), then refits them once
+	// by least squares against the indices that came out of the first fit. Always writes the four colour mode (color0 > color1),
+	// which is also the only mode BC3 has.
+	void encodeColorBlock(const unsigned char block[16][4], unsigned char* out)
+	{
+		float mean[3] = { 0.f, 0.f, 0.f };
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 3; c++) mean[c] += block[i][c];
+		}
+		for (int c = 0; c < 3; c++) mean[c] /= 16.f;
+
+		float cov[6] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f }; // rr rg rb gg gb bb
+		for (int i = 0; i < 16; i++)
+		{
+			const float r = block[i][0] - mean[0];
+			const float g = block[i][1] - mean[1];
+			const float b = block[i][2] - mean[2];
+			cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+			cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+		}
+
+		// A few rounds of power iteration are plenty to find the dominant direction of 16 points.
+		float axis[3] = { 1.f, 1.f, 1.f };
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+			const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+			const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+			const float length = std::max(std::max(std::fabs(x), std::fabs(y)), std::fabs(z));
+			if (length < 1e-6f) break; // Flat block, any axis does.
+			axis[0] = x / length;
+			axis[1] = y / length;
+			axis[2] = z / length;
+		}
+		const float axisLengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+		float minProj = 1e30f;
+		float maxProj = -1e30f;
+		for (int i = 0; i < 16; i++)
+		{
+			const float proj = ((block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2]) / axisLengthSq;
+			minProj = std::min(minProj, proj);
+			maxProj = std::max(maxProj, proj);
+		}
+		float end0[3];
+		float end1[3];
+		for (int c = 0; c < 3; c++)
+		{
+			end0[c] = mean[c] + axis[c] * maxProj;
+			end1[c] = mean[c] + axis[c] * minProj;
+		}
+
+		Color565 c0 = quantize565(end0);
+		Color565 c1 = quantize565(end1);
+		int indices[16];
+		float error = assignIndices(block, c0, c1, indices);
+
+		// Least squares: each texel is w0 * end0 + w1 * end1 for the weights its index stands for. Solve the 2x2 normal equations per channel.
+		const float weights[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+		float aa = 0.f, ab = 0.f, bb = 0.f;
+		float ax[3] = { 0.f, 0.f, 0.f };
+		float bx[3] = { 0.f, 0.f, 0.f };
+		for (int i = 0; i < 16; i++)
+		{
+			const float w0 = weights[indices[i]];
+			const float w1 = 1.f - w0;
+			aa += w0 * w0; ab += w0 * w1; bb += w1 * w1;
+			for (int c = 0; c < 3; c++)
+			{
+				ax[c] += w0 * block[i][c];
+				bx[c] += w1 * block[i][c];
+			}
+		}
+		const float det = aa * bb - ab * ab;
+		if (std::fabs(det) > 1e-6f)
+		{
+			float fit0[3];
+			float fit1[3];
+			for (int c = 0; c < 3; c++)
+			{
+				fit0[c] = (ax[c] * bb - bx[c] * ab) / det;
+				fit1[c] = (bx[c] * aa - ax[c] * ab) / det;
+			}
+			Color565 r0 = quantize565(fit0);
+			Color565 r1 = quantize565(fit1);
+			int refit[16];
+			const float refitError = assignIndices(block, r0, r1, refit);
+			if (refitError < error)
+			{
+				c0 = r0;
+				c1 = r1;
+				memcpy(indices, refit, sizeof(indices));
+			}
+		}
+
+		// color0 <= color1 would switch the block to three colours plus black. Swapping the endpoints swaps indices 0/1 and 2/3.
+		if (c0.packed < c1.packed)
+		{
+			std::swap(c0, c1);
+			for (int i = 0; i < 16; i++) indices[i] ^= 1;
+		}
+		else if (c0.packed == c1.packed)
+		{
+			for (int i = 0; i < 16; i++) indices[i] = 0;
+		}
+
+		uint32_t bits = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			bits |= (uint32_t)indices[i] << (2 * i);
+		}
+		out[0] = (unsigned char)(c0.packed & 0xFF);
+		out[1] = (unsigned char)(c0.packed >> 8);
+		out[2] = (unsigned char)(c1.packed & 0xFF);
+		out[3] = (unsigned char)(c1.packed >> 8);
+		for (int i = 0; i < 4; i++) out[4 + i] = (unsigned char)(bits >> (8 * i));
+	}
+
+	// alpha0 = max and alpha1 = min puts the block in the eight value mode, with six evenly spaced steps between them.
+	void encodeAlphaBlock(const unsigned char block[16][4], unsigned char* out)
+	{
+		int minAlpha = 255;
+		int maxAlpha = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			minAlpha = std::min(minAlpha, (int)block[i][3]);
+			maxAlpha = std::max(maxAlpha, (int)block[i][3]);
+		}
+
+		int palette[8];
+		palette[0] = maxAlpha;
+		palette[1] = minAlpha;
+		for (int k = 2; k < 8; k++)
+		{
+			palette[k] = ((8 - k) * maxAlpha + (k - 1) * minAlpha) / 7;
+		}
+
+		uint64_t bits = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0;
+			int bestError = 256;
+			for (int k = 0; k < 8 && maxAlpha != minAlpha; k++)
+			{
+				const int error = std::abs(block[i][3] - palette[k]);
+				if (error < bestError)
+				{
+					bestError = error;
+					best = k;
+				}
+			}
+			bits |= (uint64_t)best << (3 * i);
+		}
+		out[0] = (unsigned char)maxAlpha;
+		out[1] = (unsigned char)minAlpha;
+		for (int i = 0; i < 6; i++) out[2 + i] = (unsigned char)(bits >> (8 * i));
+	}
+}
+
+int compressedBlockBytes(GLenum internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGB8_ETC2:
+	case GL_COMPRESSED_SRGB8_ETC2:
+		return 8;
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+	case GL_COMPRESSED_RGBA8_ETC2_EAC:
+	case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+size_t compressedLevelSize(GLenum internalFormat, uint32_t width, uint32_t height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * compressedBlockBytes(internalFormat);
+}
+
+bool compressedFormatSupported(GLenum internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		return glExt.textureCompressionS3TC;
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		return glExt.textureCompressionS3TCsRGB;
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+		return glExt.textureCompressionBPTC;
+	case GL_COMPRESSED_RGB8_ETC2:
+	case GL_COMPRESSED_SRGB8_ETC2:
+	case GL_COMPRESSED_RGBA8_ETC2_EAC:
+	case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+		return glExt.textureCompressionETC2;
+	default:
+		return false;
+	}
+}
+
+void encodeBC1(const unsigned char* pixels, uint32_t width, uint32_t height, int channels, std::vector<unsigned char>& out)
+{
+	const uint32_t blocksX = (width + 3) / 4;
+	const uint32_t blocksY = (height + 3) / 4;
+	out.resize((size_t)blocksX * blocksY * 8);
+	unsigned char block[16][4];
+	for (uint32_t by = 0; by < blocksY; by++)
+	{
+		for (uint32_t bx = 0; bx < blocksX; bx++)
+		{
+			fetchBlock(pixels, width, height, channels, bx, by, block);
+			encodeColorBlock(block, &out[((size_t)by * blocksX + bx) * 8]);
+		}
+	}
+}
+
+void encodeBC3(const unsigned char* pixels, uint32_t width, uint32_t height, int channels, std::vector<unsigned char>& out)
+{
+	const uint32_t blocksX = (width + 3) / 4;
+	const uint32_t blocksY = (height + 3) / 4;
+	out.resize((size_t)blocksX * blocksY * 16);
+	unsigned char block[16][4];
+	for (uint32_t by = 0; by < blocksY; by++)
+	{
+		for (uint32_t bx = 0; bx < blocksX; bx++)
+		{
+			fetchBlock(pixels, width, height, channels, bx, by, block);
+			unsigned char* dst = &out[((size_t)by * blocksX + bx) * 16];
+			encodeAlphaBlock(block, dst);
+			encodeColorBlock(block, dst + 8);
+		}
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "GLExtensions.h"
+
+// Every format here stores 4x4 texel blocks at a fixed size: 8 bytes (BC1, ETC2 RGB) or 16 bytes (BC2, BC3, BC7, ETC2 RGBA).
+// Returns 0 for anything that isn't one of the block formats we know.
+int compressedBlockBytes(GLenum internalFormat);
+// Bytes in one mip level. Partial blocks at the edges still take a whole block.
+size_t compressedLevelSize(GLenum internalFormat, uint32_t width, uint32_t height);
+// Whether the current context accepts internalFormat. Needs loadGLExtensions to have run.
+bool compressedFormatSupported(GLenum internalFormat);
+
+// CPU encoders, used by --bake-textures --compress. pixels is width * height texels of channels bytes each, tightly packed.
+// A missing alpha channel reads as opaque. Texels past the right or bottom edge repeat the last row or column, so partial
+// blocks don't pull in colours that aren't there.
+// BC1 without alpha (GL_COMPRESSED_RGB_S3TC_DXT1_EXT), 8:1 against RGBA8 (6:1 against RGB8).
+void encodeBC1(const unsigned char* pixels, uint32_t width, uint32_t height, int channels, std::vector<unsigned char>& out);
+// BC3 (GL_COMPRESSED_RGBA_S3TC_DXT5_EXT), BC1 colour plus an interpolated alpha block, 4:1 against RGBA8.
+void encodeBC3(const unsigned char* pixels, uint32_t width, uint32_t height, int channels, std::vector<unsigned char>& out);
@@ -0,0 +1,35 @@
+#include "CameraBlock.h"
+#include "GLState.h"
+
+void CameraBlock::create()
+{
+	glGenBuffers(1, &ubo);
+	glState.bindBuffer(GL_UNIFORM_BUFFER, ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), nullptr, GL_DYNAMIC_DRAW);
+	glState.bindBuffer(GL_UNIFORM_BUFFER, 0);
+	// The binding point stays attached to this buffer, so programs only ever need to point their block at the binding point.
+	glState.bindBufferBase(GL_UNIFORM_BUFFER, cameraBlockBinding, ubo);
+	hasUploaded = false;
+}
+
+void CameraBlock::update(const FlyCamera& camera)
+{
+	Data data;
+	data.view = camera.getView();
+	data.proj = camera.getProj();
+	// Most frames the camera doesn't move, so there is nothing to send.
+	if (hasUploaded && data.view == uploaded.view && data.proj == uploaded.proj) return;
+
+	glState.bindBuffer(GL_UNIFORM_BUFFER, ubo);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Data), &data);
+	glState.bindBuffer(GL_UNIFORM_BUFFER, 0);
+	uploaded = data;
+	hasUploaded = true;
+}
+
+void CameraBlock::destroy()
+{
+	glDeleteBuffers(1, &ubo);
+	ubo = 0;
+	hasUploaded = false;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "FlyCamera.h"
+
+// Every program that declares "uniform Camera { mat4 view; mat4 proj; };" gets its block hooked up to this binding point when it links.
+// That way view/proj are uploaded once per frame into one buffer instead of once per program with glUniform calls.
+const char* const cameraBlockName = "Camera";
+const GLuint cameraBlockBinding = 0;
+
+class CameraBlock
+{
+public:
+	CameraBlock() = default;
+
+	void create();
+	void update(const FlyCamera& camera);
+	void destroy();
+
+private:
+	// Matches the std140 layout of the block in the shaders. Two mat4s need no padding.
+	struct Data
+	{
+		glm::mat4 view;
+		glm::mat4 proj;
+	};
+
+	GLuint ubo = 0;
+	Data uploaded;
+	bool hasUploaded = false;
+};
@@ -0,0 +1,85 @@
+#include "CommandList.h"
+#include "GLState.h"
+
+void CommandList::reserve(size_t commandCount, size_t matrixCount)
+{
+	commands.reserve(commandCount);
+	matrices.reserve(matrixCount);
+}
+
+// Keeps the capacity, so a list that is re-recorded every frame stops allocating after the first one.
+void CommandList::clear()
+{
+	commands.clear();
+	matrices.clear();
+}
+
+void CommandList::useProgram(const Shader& shader)
+{
+	push(CommandType::UseProgram, &shader, 0, 0, 0);
+}
+
+void CommandList::bindVertexArray(GLuint vao)
+{
+	push(CommandType::BindVertexArray, nullptr, vao, 0, 0);
+}
+
+void CommandList::bindTexture(GLuint unit, GLuint texture)
+{
+	push(CommandType::BindTexture, nullptr, unit, texture, 0);
+}
+
+void CommandList::drawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	push(CommandType::DrawArrays, nullptr, mode, (uint32_t)first, (uint32_t)count);
+}
+
+void CommandList::drawMesh(const MeshRange& mesh)
+{
+	push(CommandType::DrawMesh, nullptr, (uint32_t)mesh.indexCount, mesh.firstIndex, (uint32_t)mesh.baseVertex);
+}
+
+// Binds still go through glState, so the same program/VAO/texture recorded at the top of every chunk only reaches the driver once.
+void CommandList::replay() const
+{
+	for (const Command& command : commands)
+	{
+		switch (command.type)
+		{
+		case CommandType::UseProgram:
+			command.shader->use();
+			break;
+		case CommandType::BindVertexArray:
+			glState.bindVertexArray(command.a);
+			break;
+		case CommandType::BindTexture:
+			glState.bindTextureUnit(command.a, GL_TEXTURE_2D, command.b);
+			break;
+		case CommandType::SetMatrix4:
+			command.shader->write((int)command.a, matrices[command.b]);
+			break;
+		case CommandType::DrawArrays:
+			glDrawArrays(command.a, (GLint)command.b, (GLsizei)command.c);
+			break;
+		case CommandType::DrawMesh:
+			glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)command.a, arenaIndexType, (void*)(command.b * sizeof(ArenaIndex)), (GLint)command.c);
+			break;
+		}
+	}
+}
+
+size_t CommandList::size() const
+{
+	return commands.size();
+}
+
+void CommandList::push(CommandType type, const Shader* shader, uint32_t a, uint32_t b, uint32_t c)
+{
+	Command command;
+	command.type = type;
+	command.a = a;
+	command.b = b;
+	command.c = c;
+	command.shader = shader;
+	commands.push_back(command);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "shader.h"
+#include "GeometryArena.h"
+
+// A recorded sequence of rendering commands. Recording doesn't touch GL at all, so any thread can fill a list, as long as each list has one writer.
+// The thread that owns the context then calls replay(), which is a flat loop over the commands.
+// Matrices are stored next to the commands instead of inside them, which keeps every command the same small size.
+class CommandList
+{
+public:
+	CommandList() = default;
+
+	void reserve(size_t commandCount, size_t matrixCount);
+	void clear();
+
+	void useProgram(const Shader& shader);
+	void bindVertexArray(GLuint vao);
+	void bindTexture(GLuint unit, GLuint texture);
+	template<uint64_t NameHash>
+	void setUniform(const Uniform<glm::mat4, NameHash>& uniform, const glm::mat4& value)
+	{
+		push(CommandType::SetMatrix4, uniform.shader, (uint32_t)uniform.index, (uint32_t)matrices.size(), 0);
+		matrices.push_back(value);
+	}
+	void drawArrays(GLenum mode, GLint first, GLsizei count);
+	void drawMesh(const MeshRange& mesh);
+
+	void replay() const;
+	size_t size() const;
+
+private:
+	enum class CommandType : uint32_t
+	{
+		UseProgram,
+		BindVertexArray,
+		BindTexture,
+		SetMatrix4,
+		DrawArrays,
+		DrawMesh
+	};
+
+	struct Command
+	{
+		CommandType type;
+		uint32_t a;
+		uint32_t b;
+		uint32_t c;
+		const Shader* shader;
+	};
+
+	void push(CommandType type, const Shader* shader, uint32_t a, uint32_t b, uint32_t c);
+
+	std::vector<Command> commands;
+	std::vector<glm::mat4> matrices;
+};
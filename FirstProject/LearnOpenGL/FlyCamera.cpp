@@ -39,6 +39,21 @@ glm::mat4 FlyCamera::getManualView() const
 	return rot * m;
 }
 
+float FlyCamera::getFarClip() const
+{
+	return farClip;
+}
+
+glm::vec3 FlyCamera::getPosition() const
+{
+	return cameraPos;
+}
+
+glm::vec3 FlyCamera::getFront() const
+{
+	return cameraFront;
+}
+
 void FlyCamera::adjustLook(float dx, float dy)
 {
 	yaw += dx * yawSensitivity;
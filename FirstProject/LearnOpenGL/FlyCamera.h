@@ -12,6 +12,9 @@ public:
 	glm::mat4 getProj() const;
 	glm::mat4 getView() const;
 	glm::mat4 getManualView() const;
+	float getFarClip() const;
+	glm::vec3 getPosition() const;
+	glm::vec3 getFront() const;
 	void adjustLook(float dx, float dy);
 	void moveForward(float deltaTime);
 	void moveBackward(float deltaTime);
@@ -0,0 +1,279 @@
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <cfloat>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULL_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+Frustum extractFrustum(const glm::mat4& viewProj)
+{
+	// glm is column major, so row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i]).
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+	}
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[3] + rows[2];
+	frustum.planes[5] = rows[3] - rows[2];
+	// Normalized so the plane distance is in world units and can be compared against a radius.
+	for (glm::vec4& plane : frustum.planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return frustum;
+}
+
+namespace
+{
+	// Spreads the low 10 bits of v out so there are two zero bits after each one, ready to interleave with the other two axes.
+	uint32_t spreadBits(uint32_t v)
+	{
+		v = (v | (v << 16)) & 0x030000FF;
+		v = (v | (v << 8)) & 0x0300F00F;
+		v = (v | (v << 4)) & 0x030C30C3;
+		v = (v | (v << 2)) & 0x09249249;
+		return v;
+	}
+
+	int lowestBit(uint32_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, bits);
+		return (int)index;
+#else
+		return __builtin_ctz(bits);
+#endif
+	}
+
+	enum class Containment { Outside, Intersecting, Inside };
+
+	// For each plane, the corner furthest along the normal decides if the box is outside, the nearest corner if it's fully inside.
+	// The planes the box crosses go into crossing, since those are the only ones its contents still have to be tested against.
+	Containment classify(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max, int* crossing, int& crossingCount)
+	{
+		crossingCount = 0;
+		for (int p = 0; p < 6; p++)
+		{
+			const glm::vec4& plane = frustum.planes[p];
+			glm::vec3 normal(plane);
+			glm::vec3 furthest(normal.x >= 0.f ? max.x : min.x, normal.y >= 0.f ? max.y : min.y, normal.z >= 0.f ? max.z : min.z);
+			if (glm::dot(normal, furthest) + plane.w < 0.f) return Containment::Outside;
+			glm::vec3 nearest(normal.x >= 0.f ? min.x : max.x, normal.y >= 0.f ? min.y : max.y, normal.z >= 0.f ? min.z : max.z);
+			if (glm::dot(normal, nearest) + plane.w < 0.f) crossing[crossingCount++] = p;
+		}
+		return crossingCount == 0 ? Containment::Inside : Containment::Intersecting;
+	}
+}
+
+void SphereSet::resize(size_t count)
+{
+	this->count = count;
+	spheres.assign(count, glm::vec4(0.f));
+	x.clear();
+	y.clear();
+	z.clear();
+	radius.clear();
+	ids.clear();
+	blockMin.clear();
+	blockMax.clear();
+	groupMin.clear();
+	groupMax.clear();
+}
+
+void SphereSet::set(size_t index, const glm::vec3& center, float radius)
+{
+	spheres[index] = glm::vec4(center, radius);
+}
+
+void SphereSet::build()
+{
+	// Morton order over the box around the centres, so consecutive spheres, and with them each block, stay close together.
+	glm::vec3 low(FLT_MAX);
+	glm::vec3 high(-FLT_MAX);
+	for (const glm::vec4& sphere : spheres)
+	{
+		low = glm::min(low, glm::vec3(sphere));
+		high = glm::max(high, glm::vec3(sphere));
+	}
+	const glm::vec3 toGrid = 1023.f / glm::max(high - low, glm::vec3(FLT_MIN));
+	std::vector<uint64_t> keys(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		glm::uvec3 cell(glm::clamp((glm::vec3(spheres[i]) - low) * toGrid, glm::vec3(0.f), glm::vec3(1023.f)));
+		uint64_t morton = spreadBits(cell.x) | (spreadBits(cell.y) << 1) | (spreadBits(cell.z) << 2);
+		keys[i] = (morton << 32) | i;
+	}
+	std::sort(keys.begin(), keys.end());
+
+	const size_t blocks = (count + blockSize - 1) / blockSize;
+	const size_t padded = blocks * blockSize;
+	x.assign(padded, 0.f);
+	y.assign(padded, 0.f);
+	z.assign(padded, 0.f);
+	// A hugely negative radius fails every plane test, so padding is always culled.
+	radius.assign(padded, -FLT_MAX);
+	ids.assign(padded, 0);
+	blockMin.assign(blocks, glm::vec3(FLT_MAX));
+	blockMax.assign(blocks, glm::vec3(-FLT_MAX));
+	const size_t groups = (blocks + groupSize - 1) / groupSize;
+	groupMin.assign(groups, glm::vec3(FLT_MAX));
+	groupMax.assign(groups, glm::vec3(-FLT_MAX));
+	for (size_t slot = 0; slot < count; slot++)
+	{
+		const uint32_t id = (uint32_t)keys[slot];
+		const glm::vec4& sphere = spheres[id];
+		x[slot] = sphere.x;
+		y[slot] = sphere.y;
+		z[slot] = sphere.z;
+		radius[slot] = sphere.w;
+		ids[slot] = id;
+		const size_t block = slot / blockSize;
+		blockMin[block] = glm::min(blockMin[block], glm::vec3(sphere) - sphere.w);
+		blockMax[block] = glm::max(blockMax[block], glm::vec3(sphere) + sphere.w);
+	}
+	for (size_t block = 0; block < blocks; block++)
+	{
+		groupMin[block / groupSize] = glm::min(groupMin[block / groupSize], blockMin[block]);
+		groupMax[block / groupSize] = glm::max(groupMax[block / groupSize], blockMax[block]);
+	}
+}
+
+size_t SphereSet::size() const
+{
+	return count;
+}
+
+CullStats cullSpheres(const Frustum& frustum, const SphereSet& spheres, std::vector<uint32_t>& visible)
+{
+	visible.clear();
+	visible.reserve(spheres.count);
+	const float* xs = spheres.x.data();
+	const float* ys = spheres.y.data();
+	const float* zs = spheres.z.data();
+	const float* rs = spheres.radius.data();
+	const uint32_t* ids = spheres.ids.data();
+
+#if defined(__AVX__)
+	__m256 planes[6][4];
+	for (int p = 0; p < 6; p++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+		}
+	}
+#elif defined(CULL_SSE2)
+	__m128 planes[6][4];
+	for (int p = 0; p < 6; p++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+		}
+	}
+#endif
+
+	const size_t blocks = spheres.blockMin.size();
+	for (size_t group = 0; group < spheres.groupMin.size(); group++)
+	{
+		int crossing[6];
+		int crossingCount = 0;
+		const Containment groupContainment = classify(frustum, spheres.groupMin[group], spheres.groupMax[group], crossing, crossingCount);
+		if (groupContainment == Containment::Outside) continue;
+
+		const size_t lastBlock = std::min((group + 1) * SphereSet::groupSize, blocks);
+		for (size_t block = group * SphereSet::groupSize; block < lastBlock; block++)
+		{
+			// Every block of a group that is inside is inside too. Only the blocks of a group that crosses a plane need their own test.
+			const Containment containment = groupContainment == Containment::Inside ? Containment::Inside :
+				classify(frustum, spheres.blockMin[block], spheres.blockMax[block], crossing, crossingCount);
+			if (containment == Containment::Outside) continue;
+
+			const size_t begin = block * SphereSet::blockSize;
+			const size_t end = begin + SphereSet::blockSize;
+			if (containment == Containment::Inside)
+			{
+				// The last block's padding never makes it into the box, but it can still sit inside one.
+				visible.insert(visible.end(), ids + begin, ids + std::min(end, spheres.count));
+				continue;
+			}
+
+			// The block crosses a plane, so its spheres are tested one by one, but only against the planes it crosses.
+#if defined(__AVX__)
+			for (size_t i = begin; i < end; i += 8)
+			{
+				__m256 x = _mm256_loadu_ps(xs + i);
+				__m256 y = _mm256_loadu_ps(ys + i);
+				__m256 z = _mm256_loadu_ps(zs + i);
+				__m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(rs + i));
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (int k = 0; k < crossingCount; k++)
+				{
+					const int p = crossing[k];
+					__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, planes[p][0]), _mm256_mul_ps(y, planes[p][1])),
+						_mm256_add_ps(_mm256_mul_ps(z, planes[p][2]), planes[p][3]));
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+				}
+				uint32_t mask = (uint32_t)_mm256_movemask_ps(inside);
+				while (mask != 0)
+				{
+					visible.push_back(ids[i + lowestBit(mask)]);
+					mask &= mask - 1;
+				}
+			}
+#elif defined(CULL_SSE2)
+			for (size_t i = begin; i < end; i += 4)
+			{
+				__m128 x = _mm_loadu_ps(xs + i);
+				__m128 y = _mm_loadu_ps(ys + i);
+				__m128 z = _mm_loadu_ps(zs + i);
+				__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(rs + i));
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (int k = 0; k < crossingCount; k++)
+				{
+					const int p = crossing[k];
+					__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, planes[p][0]), _mm_mul_ps(y, planes[p][1])),
+						_mm_add_ps(_mm_mul_ps(z, planes[p][2]), planes[p][3]));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+				}
+				uint32_t mask = (uint32_t)_mm_movemask_ps(inside);
+				while (mask != 0)
+				{
+					visible.push_back(ids[i + lowestBit(mask)]);
+					mask &= mask - 1;
+				}
+			}
+#else
+			for (size_t i = begin; i < end; i++)
+			{
+				bool inside = true;
+				for (int k = 0; k < crossingCount && inside; k++)
+				{
+					const glm::vec4& plane = frustum.planes[crossing[k]];
+					inside = xs[i] * plane.x + ys[i] * plane.y + zs[i] * plane.z + plane.w >= -rs[i];
+				}
+				if (inside) visible.push_back(ids[i]);
+			}
+#endif
+		}
+	}
+
+	CullStats stats;
+	stats.visible = (unsigned int)visible.size();
+	stats.culled = (unsigned int)(spheres.count - visible.size());
+	return stats;
+}
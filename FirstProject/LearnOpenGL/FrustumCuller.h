@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Six planes (left, right, bottom, top, near, far) as (normal, d), normalized and pointing inwards. A point p is inside a plane when dot(normal, p) + d >= 0.
+struct Frustum
+{
+	glm::vec4 planes[6];
+};
+
+// Gribb/Hartmann extraction. The planes come straight out of the rows of proj * view, in world space.
+Frustum extractFrustum(const glm::mat4& viewProj);
+
+struct CullStats
+{
+	unsigned int visible = 0;
+	unsigned int culled = 0;
+};
+
+// Bounding spheres in structure of arrays form, so the SIMD test can load 4 (SSE) or 8 (AVX) of the same component at once.
+// build() sorts them along a Morton curve, puts every 64 neighbours in a block with a bounding box and every 16 blocks in a group
+// with a box around those. cullSpheres tests the boxes first, so most spheres are rejected or accepted a whole group or block at a
+// time and only blocks that cross a plane are tested sphere by sphere. The arrays are padded up to a whole block with spheres that can never be visible.
+class SphereSet
+{
+public:
+	void resize(size_t count);
+	void set(size_t index, const glm::vec3& center, float radius);
+	// Call after the last set() and before culling. Spheres changed afterwards are only seen after another build().
+	void build();
+	size_t size() const;
+
+private:
+	friend CullStats cullSpheres(const Frustum& frustum, const SphereSet& spheres, std::vector<uint32_t>& visible);
+
+	static const size_t blockSize = 64;
+	static const size_t groupSize = 16; // In blocks.
+
+	size_t count = 0;
+	std::vector<glm::vec4> spheres; // Centre and radius as passed to set(), in index order.
+	// The sorted copy the culling reads. ids maps a slot back to the index it was set() at.
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> radius;
+	std::vector<uint32_t> ids;
+	std::vector<glm::vec3> blockMin;
+	std::vector<glm::vec3> blockMax;
+	std::vector<glm::vec3> groupMin;
+	std::vector<glm::vec3> groupMax;
+};
+
+// Writes the indices of the spheres that touch the frustum into visible. They come out block by block in build()'s Morton order,
+// not in ascending order.
+// Uses AVX when the build targets it (the project compiles with /arch:AVX2), SSE2 otherwise, and plain scalar code on anything without SSE.
+CullStats cullSpheres(const Frustum& frustum, const SphereSet& spheres, std::vector<uint32_t>& visible);
@@ -0,0 +1,91 @@
+#include "GLExtensions.h"
+#include <cstring>
+#include <iostream>
+
+GLExtensions glExt;
+
+bool hasGLExtension(const char* name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+		if (extension != nullptr && strcmp(extension, name) == 0) return true;
+	}
+	return false;
+}
+
+bool hasGLVersion(int major, int minor)
+{
+	return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
+
+void loadGLExtensions(GLADloadproc load)
+{
+	glExt = GLExtensions();
+
+	if (hasGLVersion(4, 1) || hasGLExtension("GL_ARB_get_program_binary"))
+	{
+		glExt.getProgramBinary = (PFNGLGETPROGRAMBINARYPROC_EXT)load("glGetProgramBinary");
+		glExt.programBinaryLoad = (PFNGLPROGRAMBINARYPROC_EXT)load("glProgramBinary");
+		glExt.programParameteri = (PFNGLPROGRAMPARAMETERIPROC_EXT)load("glProgramParameteri");
+		// Some drivers expose the extension but support zero formats, which means nothing can actually be saved.
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		glExt.programBinary = glExt.getProgramBinary != nullptr && glExt.programBinaryLoad != nullptr && glExt.programParameteri != nullptr && formats > 0;
+	}
+
+	if (hasGLExtension("GL_KHR_parallel_shader_compile"))
+	{
+		glExt.maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSPROC_EXT)load("glMaxShaderCompilerThreadsKHR");
+	}
+	else if (hasGLExtension("GL_ARB_parallel_shader_compile"))
+	{
+		glExt.maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSPROC_EXT)load("glMaxShaderCompilerThreadsARB");
+	}
+	glExt.parallelShaderCompile = glExt.maxShaderCompilerThreads != nullptr;
+
+	if (hasGLVersion(4, 4) || hasGLExtension("GL_ARB_buffer_storage"))
+	{
+		glExt.bufferStorageAlloc = (PFNGLBUFFERSTORAGEPROC_EXT)load("glBufferStorage");
+	}
+	glExt.bufferStorage = glExt.bufferStorageAlloc != nullptr;
+
+	if (hasGLVersion(4, 3) || (hasGLExtension("GL_ARB_multi_draw_indirect") && hasGLExtension("GL_ARB_base_instance")))
+	{
+		glExt.multiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT)load("glMultiDrawElementsIndirect");
+	}
+	glExt.multiDrawIndirect = glExt.multiDrawElementsIndirect != nullptr;
+
+	glExt.textureCompressionS3TC = hasGLExtension("GL_EXT_texture_compression_s3tc");
+	glExt.textureCompressionS3TCsRGB = glExt.textureCompressionS3TC && (hasGLExtension("GL_EXT_texture_sRGB") || hasGLExtension("GL_EXT_texture_compression_s3tc_srgb"));
+	glExt.textureCompressionBPTC = hasGLVersion(4, 2) || hasGLExtension("GL_ARB_texture_compression_bptc");
+	glExt.textureCompressionETC2 = hasGLVersion(4, 3) || hasGLExtension("GL_ARB_ES3_compatibility");
+
+	if (hasGLVersion(4, 2) || hasGLExtension("GL_ARB_texture_storage"))
+	{
+		glExt.texStorage2D = (PFNGLTEXSTORAGE2DPROC_EXT)load("glTexStorage2D");
+	}
+	glExt.textureStorage = glExt.texStorage2D != nullptr;
+	glExt.rgb565 = hasGLVersion(4, 1) || hasGLExtension("GL_ARB_ES2_compatibility");
+
+	if (hasGLVersion(4, 3) || hasGLExtension("GL_ARB_vertex_attrib_binding"))
+	{
+		glExt.bindVertexBuffer = (PFNGLBINDVERTEXBUFFERPROC_EXT)load("glBindVertexBuffer");
+		glExt.vertexAttribFormat = (PFNGLVERTEXATTRIBFORMATPROC_EXT)load("glVertexAttribFormat");
+		glExt.attribBinding = (PFNGLVERTEXATTRIBBINDINGPROC_EXT)load("glVertexAttribBinding");
+		glExt.vertexBindingDivisor = (PFNGLVERTEXBINDINGDIVISORPROC_EXT)load("glVertexBindingDivisor");
+	}
+	glExt.vertexAttribBinding = glExt.bindVertexBuffer != nullptr && glExt.vertexAttribFormat != nullptr && glExt.attribBinding != nullptr && glExt.vertexBindingDivisor != nullptr;
+
+	std::cout << "Program binaries " << (glExt.programBinary ? "supported" : "not supported")
+		<< ", parallel shader compile " << (glExt.parallelShaderCompile ? "supported" : "not supported")
+		<< ", buffer storage " << (glExt.bufferStorage ? "supported" : "not supported")
+		<< ", multi-draw indirect " << (glExt.multiDrawIndirect ? "supported" : "not supported")
+		<< ", texture storage " << (glExt.textureStorage ? "supported" : "not supported")
+		<< ", vertex attrib binding " << (glExt.vertexAttribBinding ? "supported" : "not supported") << '\n';
+	std::cout << "Compressed textures: S3TC " << (glExt.textureCompressionS3TC ? "supported" : "not supported")
+		<< ", BPTC " << (glExt.textureCompressionBPTC ? "supported" : "not supported")
+		<< ", ETC2 " << (glExt.textureCompressionETC2 ? "supported" : "not supported") << '\n';
+}
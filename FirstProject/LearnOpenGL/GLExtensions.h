@@ -0,0 +1,124 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// glad was generated for plain GL 3.3, so anything newer is declared here and loaded by hand once the context exists.
+// Check the matching flag before calling any of these. They stay null when the driver doesn't have the feature.
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_RGB565
+#define GL_RGB565 0x8D62
+#endif
+#ifndef GL_TEXTURE_IMMUTABLE_FORMAT
+#define GL_TEXTURE_IMMUTABLE_FORMAT 0x912F
+#endif
+
+// Block compressed texture formats. They all go through the core glCompressedTexImage2D, so there is nothing to load for them, only flags to check.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#define GL_COMPRESSED_SRGB8_ETC2 0x9275
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC 0x9279
+#endif
+
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC_EXT)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC_EXT)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC_EXT)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSPROC_EXT)(GLuint count);
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC_EXT)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLTEXSTORAGE2DPROC_EXT)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void (APIENTRYP PFNGLBINDVERTEXBUFFERPROC_EXT)(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+typedef void (APIENTRYP PFNGLVERTEXATTRIBFORMATPROC_EXT)(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+typedef void (APIENTRYP PFNGLVERTEXATTRIBBINDINGPROC_EXT)(GLuint attribindex, GLuint bindingindex);
+typedef void (APIENTRYP PFNGLVERTEXBINDINGDIVISORPROC_EXT)(GLuint bindingindex, GLuint divisor);
+
+struct GLExtensions
+{
+	// GL 4.1 or ARB_get_program_binary, with at least one binary format the driver will hand out.
+	bool programBinary = false;
+	PFNGLGETPROGRAMBINARYPROC_EXT getProgramBinary = nullptr;
+	PFNGLPROGRAMBINARYPROC_EXT programBinaryLoad = nullptr;
+	PFNGLPROGRAMPARAMETERIPROC_EXT programParameteri = nullptr;
+
+	// KHR_parallel_shader_compile or the ARB version. Compiles and links run on driver threads and GL_COMPLETION_STATUS_KHR can be polled without blocking.
+	bool parallelShaderCompile = false;
+	PFNGLMAXSHADERCOMPILERTHREADSPROC_EXT maxShaderCompilerThreads = nullptr;
+
+	// GL 4.4 or ARB_buffer_storage. Immutable buffers that can stay mapped while the GPU reads from them.
+	bool bufferStorage = false;
+	PFNGLBUFFERSTORAGEPROC_EXT bufferStorageAlloc = nullptr;
+
+	// GL 4.3, or ARB_multi_draw_indirect together with ARB_base_instance. The base instance is what lets each draw find its own per-object data.
+	bool multiDrawIndirect = false;
+	PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT multiDrawElementsIndirect = nullptr;
+
+	// EXT_texture_compression_s3tc (BC1 to BC3), and the sRGB versions from EXT_texture_sRGB or EXT_texture_compression_s3tc_srgb.
+	bool textureCompressionS3TC = false;
+	bool textureCompressionS3TCsRGB = false;
+	// GL 4.2 or ARB_texture_compression_bptc (BC7).
+	bool textureCompressionBPTC = false;
+	// GL 4.3 or ARB_ES3_compatibility. Core desktop GL has to accept ETC2 from then on, even if the driver decompresses it behind our back.
+	bool textureCompressionETC2 = false;
+
+	// GL 4.2 or ARB_texture_storage. Allocates every level at once with a format that can't change afterwards, so the driver
+	// never has to guess what the rest of the mip chain will look like or check the texture for completeness at draw time.
+	bool textureStorage = false;
+	PFNGLTEXSTORAGE2DPROC_EXT texStorage2D = nullptr;
+
+	// GL 4.1 or ARB_ES2_compatibility, which is where GL_RGB565 became a valid internal format.
+	bool rgb565 = false;
+
+	// GL 4.3 or ARB_vertex_attrib_binding. The attribute format is set once and only the buffer and offset behind it change.
+	bool vertexAttribBinding = false;
+	PFNGLBINDVERTEXBUFFERPROC_EXT bindVertexBuffer = nullptr;
+	PFNGLVERTEXATTRIBFORMATPROC_EXT vertexAttribFormat = nullptr;
+	PFNGLVERTEXATTRIBBINDINGPROC_EXT attribBinding = nullptr;
+	PFNGLVERTEXBINDINGDIVISORPROC_EXT vertexBindingDivisor = nullptr;
+};
+
+extern GLExtensions glExt;
+
+// Call right after gladLoadGLLoader with the same loader.
+void loadGLExtensions(GLADloadproc load);
+bool hasGLExtension(const char* name);
+bool hasGLVersion(int major, int minor);
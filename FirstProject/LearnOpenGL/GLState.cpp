@@ -0,0 +1,183 @@
+#include "GLState.h"
+
+GLStateCache glState;
+
+namespace
+{
+	const GLenum textureTargets[] = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP };
+	const GLenum bufferTargets[] = { GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_PIXEL_PACK_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER };
+	const GLenum capabilities[] = { GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_STENCIL_TEST, GL_SCISSOR_TEST };
+}
+
+GLStateCache::GLStateCache()
+{
+	invalidate();
+}
+
+void GLStateCache::useProgram(GLuint newProgram)
+{
+	if (change(program, newProgram)) glUseProgram(newProgram);
+}
+
+void GLStateCache::bindVertexArray(GLuint newVao)
+{
+	if (!change(vao, newVao)) return;
+	glBindVertexArray(newVao);
+	// The element buffer binding is part of the VAO, so switching VAOs switches it too.
+	buffers[bufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = unknown;
+}
+
+void GLStateCache::activeTexture(GLuint unit)
+{
+	if (change(activeUnit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+	int index = textureTargetIndex(target);
+	if (index < 0 || activeUnit == unknown || activeUnit >= maxTextureUnits)
+	{
+		counters.issued++;
+		glBindTexture(target, texture);
+		if (index >= 0 && activeUnit == unknown)
+		{
+			// We don't know which unit that landed on, so none of the shadows for this target can be trusted any more.
+			for (int unit = 0; unit < maxTextureUnits; unit++)
+			{
+				textures[unit][index] = unknown;
+			}
+		}
+		return;
+	}
+	if (change(textures[activeUnit][index], texture)) glBindTexture(target, texture);
+}
+
+void GLStateCache::bindTextureUnit(GLuint unit, GLenum target, GLuint texture)
+{
+	// Check the binding first. When the texture is already there, there is no reason to switch units either.
+	int index = textureTargetIndex(target);
+	if (index >= 0 && unit < maxTextureUnits && textures[unit][index] == texture)
+	{
+		counters.skipped++;
+		return;
+	}
+	activeTexture(unit);
+	bindTexture(target, texture);
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	int index = bufferTargetIndex(target);
+	if (index < 0)
+	{
+		counters.issued++;
+		glBindBuffer(target, buffer);
+		return;
+	}
+	if (change(buffers[index], buffer)) glBindBuffer(target, buffer);
+}
+
+// Also binds the buffer to the generic target, so that shadow has to follow along.
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	counters.issued++;
+	glBindBufferBase(target, index, buffer);
+	int targetIndex = bufferTargetIndex(target);
+	if (targetIndex >= 0) buffers[targetIndex] = buffer;
+}
+
+void GLStateCache::enable(GLenum cap)
+{
+	int index = capIndex(cap);
+	if (index < 0)
+	{
+		counters.issued++;
+		glEnable(cap);
+		return;
+	}
+	if (change(caps[index], GL_TRUE)) glEnable(cap);
+}
+
+void GLStateCache::disable(GLenum cap)
+{
+	int index = capIndex(cap);
+	if (index < 0)
+	{
+		counters.issued++;
+		glDisable(cap);
+		return;
+	}
+	if (change(caps[index], GL_FALSE)) glDisable(cap);
+}
+
+void GLStateCache::invalidate()
+{
+	program = unknown;
+	vao = unknown;
+	activeUnit = unknown;
+	for (int unit = 0; unit < maxTextureUnits; unit++)
+	{
+		for (int target = 0; target < textureTargetCount; target++)
+		{
+			textures[unit][target] = unknown;
+		}
+	}
+	for (int i = 0; i < bufferTargetCount; i++)
+	{
+		buffers[i] = unknown;
+	}
+	for (int i = 0; i < capCount; i++)
+	{
+		caps[i] = unknown;
+	}
+}
+
+GLStateCache::Counters GLStateCache::getCounters() const
+{
+	return counters;
+}
+
+void GLStateCache::resetCounters()
+{
+	counters = Counters();
+}
+
+int GLStateCache::textureTargetIndex(GLenum target)
+{
+	for (int i = 0; i < textureTargetCount; i++)
+	{
+		if (textureTargets[i] == target) return i;
+	}
+	return -1;
+}
+
+int GLStateCache::bufferTargetIndex(GLenum target)
+{
+	for (int i = 0; i < bufferTargetCount; i++)
+	{
+		if (bufferTargets[i] == target) return i;
+	}
+	return -1;
+}
+
+int GLStateCache::capIndex(GLenum cap)
+{
+	for (int i = 0; i < capCount; i++)
+	{
+		if (capabilities[i] == cap) return i;
+	}
+	return -1;
+}
+
+// Updates the shadow and says whether the real call is needed.
+bool GLStateCache::change(GLuint& shadow, GLuint value)
+{
+	if (shadow == value)
+	{
+		counters.skipped++;
+		return false;
+	}
+	shadow = value;
+	counters.issued++;
+	return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Shadows the bits of GL state we change every frame and drops calls that would set something to the value it already has.
+// This only works if everything goes through it. Code that calls glBind*/glUseProgram/glEnable directly has to call invalidate() afterwards.
+class GLStateCache
+{
+public:
+	struct Counters
+	{
+		unsigned int issued = 0;
+		unsigned int skipped = 0;
+	};
+
+	GLStateCache();
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vao);
+	void activeTexture(GLuint unit);
+	// Binds to whichever unit is active, like glBindTexture.
+	void bindTexture(GLenum target, GLuint texture);
+	void bindTextureUnit(GLuint unit, GLenum target, GLuint texture);
+	void bindBuffer(GLenum target, GLuint buffer);
+	void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	void enable(GLenum cap);
+	void disable(GLenum cap);
+
+	// Forgets everything, so the next call of each kind always goes through.
+	void invalidate();
+
+	Counters getCounters() const;
+	void resetCounters();
+
+private:
+	static const GLuint unknown = 0xFFFFFFFF;
+	static const int maxTextureUnits = 32;
+	static const int textureTargetCount = 3;
+	static const int bufferTargetCount = 7;
+	static const int capCount = 5;
+
+	static int textureTargetIndex(GLenum target);
+	static int bufferTargetIndex(GLenum target);
+	static int capIndex(GLenum cap);
+	bool change(GLuint& shadow, GLuint value);
+
+	GLuint program;
+	GLuint vao;
+	GLuint activeUnit;
+	GLuint textures[maxTextureUnits][textureTargetCount];
+	GLuint buffers[bufferTargetCount];
+	GLuint caps[capCount];
+	Counters counters;
+};
+
+extern GLStateCache glState;
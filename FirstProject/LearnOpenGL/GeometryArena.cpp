@@ -0,0 +1,209 @@
+#include "GeometryArena.h"
+#include <iostream>
+#include "GLState.h"
+
+void FreeList::reset(uint32_t capacity)
+{
+	blocks.clear();
+	if (capacity > 0)
+	{
+		blocks.push_back({ 0, capacity });
+	}
+}
+
+bool FreeList::allocate(uint32_t count, uint32_t& outOffset)
+{
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		if (blocks[i].count < count) continue;
+
+		outOffset = blocks[i].offset;
+		blocks[i].offset += count;
+		blocks[i].count -= count;
+		if (blocks[i].count == 0)
+		{
+			blocks.erase(blocks.begin() + i);
+		}
+		return true;
+	}
+	return false;
+}
+
+void FreeList::free(uint32_t offset, uint32_t count)
+{
+	if (count == 0) return;
+
+	size_t i = 0;
+	while (i < blocks.size() && blocks[i].offset < offset)
+	{
+		i++;
+	}
+	blocks.insert(blocks.begin() + i, { offset, count });
+
+	// Merge with the block after, then with the block before.
+	if (i + 1 < blocks.size() && blocks[i].offset + blocks[i].count == blocks[i + 1].offset)
+	{
+		blocks[i].count += blocks[i + 1].count;
+		blocks.erase(blocks.begin() + i + 1);
+	}
+	if (i > 0 && blocks[i - 1].offset + blocks[i - 1].count == blocks[i].offset)
+	{
+		blocks[i - 1].count += blocks[i].count;
+		blocks.erase(blocks.begin() + i);
+	}
+}
+
+void GeometryArena::create(uint32_t maxVertices, uint32_t maxIndices)
+{
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ebo);
+	glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)maxVertices * sizeof(PackedVertex), nullptr, GL_STATIC_DRAW);
+	glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+	vertexSpace.reset(maxVertices);
+	indexSpace.reset(maxIndices);
+
+	vao = makeVAO();
+
+	// The element buffer has to be bound with a VAO bound, or it isn't recorded anywhere. Size it through the arena's own VAO.
+	glState.bindVertexArray(vao);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)maxIndices * sizeof(ArenaIndex), nullptr, GL_STATIC_DRAW);
+	glState.bindVertexArray(0);
+}
+
+MeshRange GeometryArena::add(const MeshData& mesh)
+{
+	MeshRange range;
+	if (mesh.vertices.size() > 65536)
+	{
+		std::cout << "Geometry arena can't take a mesh of " << mesh.vertices.size() << " vertices, its indices are 16 bits\n";
+		return range;
+	}
+	uint32_t vertexOffset = 0;
+	uint32_t indexOffset = 0;
+	if (!vertexSpace.allocate((uint32_t)mesh.vertices.size(), vertexOffset))
+	{
+		std::cout << "Geometry arena is out of vertex space for a mesh of " << mesh.vertices.size() << " vertices\n";
+		return range;
+	}
+	if (!indexSpace.allocate((uint32_t)mesh.indices.size(), indexOffset))
+	{
+		std::cout << "Geometry arena is out of index space for a mesh of " << mesh.indices.size() << " indices\n";
+		vertexSpace.free(vertexOffset, (uint32_t)mesh.vertices.size());
+		return range;
+	}
+
+	std::vector<PackedVertex> packedVertices(mesh.vertices.size());
+	bool clamped = false;
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		const glm::vec2& uv = mesh.vertices[i].texCoord;
+		clamped = clamped || uv.x < 0.f || uv.x > 1.f || uv.y < 0.f || uv.y > 1.f;
+		packedVertices[i] = packVertex(mesh.vertices[i]);
+	}
+	if (clamped)
+	{
+		std::cout << "Geometry arena clamped texture coords outside [0, 1] to fit them in 16 bits\n";
+	}
+
+	glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)vertexOffset * sizeof(PackedVertex), packedVertices.size() * sizeof(PackedVertex), packedVertices.data());
+	glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+	std::vector<ArenaIndex> narrowIndices(mesh.indices.begin(), mesh.indices.end());
+	glState.bindVertexArray(vao);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)indexOffset * sizeof(ArenaIndex), narrowIndices.size() * sizeof(ArenaIndex), narrowIndices.data());
+	glState.bindVertexArray(0);
+
+	range.baseVertex = (GLint)vertexOffset;
+	range.firstIndex = indexOffset;
+	range.indexCount = (GLsizei)mesh.indices.size();
+	range.vertexCount = (GLsizei)mesh.vertices.size();
+	return range;
+}
+
+// The data stays in the buffers, the space just becomes available to the next add().
+void GeometryArena::remove(const MeshRange& range)
+{
+	vertexSpace.free((uint32_t)range.baseVertex, (uint32_t)range.vertexCount);
+	indexSpace.free(range.firstIndex, (uint32_t)range.indexCount);
+}
+
+GLuint GeometryArena::createVAO()
+{
+	GLuint newVao = makeVAO();
+	extraVAOs.push_back(newVao);
+	return newVao;
+}
+
+GLuint GeometryArena::makeVAO() const
+{
+	GLuint newVao = 0;
+	glGenVertexArrays(1, &newVao);
+	glState.bindVertexArray(newVao);
+	glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+	glState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	packedVertexLayout().apply();
+	// Unbind the VAO before the buffers, otherwise the element buffer unbind would be recorded into it.
+	glState.bindVertexArray(0);
+	glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+	return newVao;
+}
+
+void GeometryArena::destroy()
+{
+	for (GLuint extra : extraVAOs)
+	{
+		glDeleteVertexArrays(1, &extra);
+	}
+	extraVAOs.clear();
+	glDeleteVertexArrays(1, &vao);
+	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &ebo);
+	vao = 0;
+	vbo = 0;
+	ebo = 0;
+	glState.invalidate();
+}
+
+GLuint GeometryArena::getVAO() const
+{
+	return vao;
+}
+
+GLuint GeometryArena::getVertexBuffer() const
+{
+	return vbo;
+}
+
+GLuint GeometryArena::getIndexBuffer() const
+{
+	return ebo;
+}
+
+PackedVertex packVertex(const Vertex& vertex)
+{
+	PackedVertex packed;
+	packed.position = Half4(vertex.position);
+	packed.color = Unorm8x4(vertex.color);
+	packed.texCoord = Unorm16x2(vertex.texCoord);
+	return packed;
+}
+
+VertexLayout<PackedVertex> packedVertexLayout()
+{
+	VertexLayout<PackedVertex> layout;
+	layout.add(0, &PackedVertex::position)
+		.add(1, &PackedVertex::color)
+		.add(2, &PackedVertex::texCoord);
+	return layout;
+}
+
+void drawMesh(const MeshRange& range)
+{
+	glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, arenaIndexType, (void*)(range.firstIndex * sizeof(ArenaIndex)), range.baseVertex);
+}
+
+void drawMeshInstanced(const MeshRange& range, GLsizei instanceCount)
+{
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.indexCount, arenaIndexType, (void*)(range.firstIndex * sizeof(ArenaIndex)), instanceCount, range.baseVertex);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "VertexLayout.h"
+
+// The format meshes are built and processed in. Full floats, so the mesh code never has to think about packing.
+struct Vertex
+{
+	glm::vec3 position = glm::vec3(0.f);
+	glm::vec3 color = glm::vec3(0.f);
+	glm::vec2 texCoord = glm::vec2(0.f);
+};
+
+// What the arena actually stores, 16 bytes instead of Vertex's 32. Positions, colors and texture coords go to attribute locations 0, 1 and 2,
+// like the shaders expect, and GL turns them back into floats on fetch.
+struct PackedVertex
+{
+	Half4 position;
+	Unorm8x4 color;
+	Unorm16x2 texCoord;
+};
+
+PackedVertex packVertex(const Vertex& vertex);
+VertexLayout<PackedVertex> packedVertexLayout();
+
+// Meshes are built and processed with 32-bit indices, but the arena stores them as 16 bits. Indices are relative to the mesh's
+// baseVertex, so the limit is 65536 vertices per mesh, not for the whole arena, and the index buffer is half the size.
+typedef uint16_t ArenaIndex;
+const GLenum arenaIndexType = GL_UNSIGNED_SHORT;
+
+struct MeshData
+{
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+};
+
+// Where a mesh lives inside the arena. Indices are relative to the mesh's own first vertex, and baseVertex adds the offset at draw time.
+struct MeshRange
+{
+	GLint baseVertex = 0;
+	GLuint firstIndex = 0;
+	GLsizei indexCount = 0;
+	GLsizei vertexCount = 0;
+};
+
+// First fit allocator over a range of [0, capacity) elements. Freed blocks are merged with their neighbours so the space doesn't fragment into crumbs.
+class FreeList
+{
+public:
+	void reset(uint32_t capacity);
+	// Returns false when no free block is big enough.
+	bool allocate(uint32_t count, uint32_t& outOffset);
+	void free(uint32_t offset, uint32_t count);
+
+private:
+	struct Block
+	{
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	std::vector<Block> blocks; // Sorted by offset.
+};
+
+// Keeps every mesh in one big vertex buffer and one big index buffer, suballocated with free lists, instead of a VBO/EBO pair per mesh.
+// All meshes share the same VAO, so switching from one mesh to another is just different numbers in the draw call, and every mesh
+// can be reached from a single multi-draw. The buffers are sized once at create() and never move, so a MeshRange stays valid until it's removed.
+class GeometryArena
+{
+public:
+	GeometryArena() = default;
+
+	void create(uint32_t maxVertices, uint32_t maxIndices);
+	// An empty range (indexCount 0) means the arena is out of room, or the mesh has too many vertices for 16-bit indices.
+	MeshRange add(const MeshData& mesh);
+	void remove(const MeshRange& range);
+	// A new VAO over the arena's buffers. Useful when a path needs extra attributes (like instance matrices) that others must not see.
+	GLuint createVAO();
+	void destroy();
+
+	GLuint getVAO() const;
+	GLuint getVertexBuffer() const;
+	GLuint getIndexBuffer() const;
+
+private:
+	GLuint makeVAO() const;
+
+	GLuint vao = 0;
+	GLuint vbo = 0;
+	GLuint ebo = 0;
+	FreeList vertexSpace;
+	FreeList indexSpace;
+	std::vector<GLuint> extraVAOs;
+};
+
+// Draws one mesh out of whichever arena VAO is bound.
+void drawMesh(const MeshRange& range);
+void drawMeshInstanced(const MeshRange& range, GLsizei instanceCount);
@@ -0,0 +1,92 @@
+#include "InstanceBuffer.h"
+#include <cstring>
+#include "GLExtensions.h"
+#include "GLState.h"
+
+void InstanceBuffer::attach(GLuint vao, GLuint firstLocation)
+{
+	this->vao = vao;
+	this->firstLocation = firstLocation;
+	boundBuffer = 0;
+	boundOffset = -1;
+
+	glState.bindVertexArray(vao);
+	for (GLuint i = 0; i < 4; i++)
+	{
+		glEnableVertexAttribArray(firstLocation + i);
+		if (glExt.vertexAttribBinding)
+		{
+			// All four columns read from one binding point, the one numbered like the first column. The other attributes are set up with
+			// glVertexAttribPointer, which uses the binding point with the attribute's own number, so nothing else shares it.
+			glExt.vertexAttribFormat(firstLocation + i, 4, GL_FLOAT, GL_FALSE, i * sizeof(glm::vec4));
+			glExt.attribBinding(firstLocation + i, firstLocation);
+		}
+		else
+		{
+			// A divisor of 1 advances the attribute once per instance instead of once per vertex.
+			glVertexAttribDivisor(firstLocation + i, 1);
+		}
+	}
+	if (glExt.vertexAttribBinding)
+	{
+		glExt.vertexBindingDivisor(firstLocation, 1);
+	}
+	glState.bindVertexArray(0);
+}
+
+// Copies the matrices into this frame's slice of the ring. Returns false if they didn't fit, in which case nothing should be drawn with them.
+bool InstanceBuffer::upload(RingBuffer& ring, const std::vector<glm::mat4>& models)
+{
+	const size_t size = models.size() * sizeof(glm::mat4);
+	RingBuffer::Allocation allocation = ring.map(size, sizeof(glm::vec4));
+	if (allocation.data == nullptr) return false;
+
+	memcpy(allocation.data, models.data(), size);
+	ring.unmap(allocation);
+	pointAttributes(ring.getBuffer(), allocation.offset);
+	return true;
+}
+
+void InstanceBuffer::uploadStatic(const std::vector<glm::mat4>& models)
+{
+	if (staticBuffer == 0)
+	{
+		glGenBuffers(1, &staticBuffer);
+	}
+	glState.bindBuffer(GL_ARRAY_BUFFER, staticBuffer);
+	glBufferData(GL_ARRAY_BUFFER, models.size() * sizeof(glm::mat4), models.data(), GL_STATIC_DRAW);
+	pointAttributes(staticBuffer, 0);
+}
+
+void InstanceBuffer::destroy()
+{
+	glDeleteBuffers(1, &staticBuffer);
+	staticBuffer = 0;
+	boundBuffer = 0;
+	boundOffset = -1;
+}
+
+// Only state changes either way, no memory moves.
+void InstanceBuffer::pointAttributes(GLuint buffer, GLintptr offset)
+{
+	if (buffer == boundBuffer && offset == boundOffset) return;
+	boundBuffer = buffer;
+	boundOffset = offset;
+
+	glState.bindVertexArray(vao);
+	if (glExt.vertexAttribBinding)
+	{
+		glExt.bindVertexBuffer(firstLocation, buffer, offset, sizeof(glm::mat4));
+		return;
+	}
+	glState.bindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (GLuint i = 0; i < 4; i++)
+	{
+		glVertexAttribPointer(firstLocation + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(offset + i * sizeof(glm::vec4)));
+	}
+}
+
+GLintptr InstanceBuffer::getOffset() const
+{
+	return boundOffset;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "RingBuffer.h"
+
+// Feeds one model matrix per instance to a VAO so a whole batch of objects can go out in a single glDrawArraysInstanced call.
+// A mat4 attribute takes up 4 consecutive attribute locations, one per column.
+// The matrices live in the per-frame RingBuffer, and with three regions in flight this frame's copy lands somewhere new every frame.
+// With vertex attribute binding (GL 4.3) the four column formats are set once in attach() and following the data is one glBindVertexBuffer.
+// Without it the offset is baked into the attribute pointers, so all four are respecified whenever the data moves.
+class InstanceBuffer
+{
+public:
+	InstanceBuffer() = default;
+
+	void attach(GLuint vao, GLuint firstLocation);
+	bool upload(RingBuffer& ring, const std::vector<glm::mat4>& models);
+	// For objects that never move. The matrices go into a buffer of this instance buffer's own, written once here and never touched
+	// again, so drawing them costs no CPU work per frame beyond the draw call.
+	void uploadStatic(const std::vector<glm::mat4>& models);
+	void destroy();
+	// Points instance 0 at the matrix stored at offset. Lets one upload be drawn in pieces, each piece starting at its own matrix.
+	// Does nothing if that is where it already points.
+	void pointAttributes(GLuint buffer, GLintptr offset);
+	GLintptr getOffset() const;
+
+private:
+	GLuint vao = 0;
+	GLuint firstLocation = 0;
+	GLuint boundBuffer = 0;
+	GLintptr boundOffset = -1;
+	GLuint staticBuffer = 0;
+};
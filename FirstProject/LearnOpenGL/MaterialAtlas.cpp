@@ -0,0 +1,236 @@
+#include "MaterialAtlas.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <stb_image.h>
+#include "GLState.h"
+#include "MipChain.h"
+#include "TextureFormat.h"
+
+MaterialAtlas::MaterialAtlas(ThreadPool& pool)
+	: pool(pool)
+{
+}
+
+int MaterialAtlas::add(const std::string& path, GLenum wrap)
+{
+	Image image;
+	image.path = path;
+	images.push_back(image);
+	MaterialTexture material;
+	material.repeat = wrap == GL_REPEAT;
+	materials.push_back(material);
+	return (int)images.size() - 1;
+}
+
+bool MaterialAtlas::build(int pageSize, int padding)
+{
+	bool success = true;
+	pool.parallelFor(images.size(), [this](size_t i)
+	{
+		// The flip setting is global by default. The _thread version only affects loads on this worker.
+		stbi_set_flip_vertically_on_load_thread(true);
+		int channels = 0;
+		Image& image = images[i];
+		// Always 4 channels, every layer of an array has the same format.
+		unsigned char* data = stbi_load(image.path.c_str(), &image.width, &image.height, &channels, 4);
+		if (data != nullptr)
+		{
+			image.rgba.assign(data, data + (size_t)image.width * image.height * 4);
+		}
+		stbi_image_free(data);
+	});
+	for (Image& image : images)
+	{
+		if (!image.rgba.empty()) continue;
+		std::cout << "Failed to load material texture " << image.path << '\n';
+		image.width = 1;
+		image.height = 1;
+		image.rgba = { 128, 128, 128, 255 };
+		success = false;
+	}
+
+	// Same sized images go together. A size with a single image goes to the atlas, unless it can't fit on a page.
+	std::map<std::pair<int, int>, std::vector<int>> bySize;
+	for (int i = 0; i < (int)images.size(); i++)
+	{
+		bySize[std::make_pair(images[i].width, images[i].height)].push_back(i);
+	}
+	std::vector<int> atlasImages;
+	for (auto& group : bySize)
+	{
+		const int width = group.first.first;
+		const int height = group.first.second;
+		const bool fitsPage = width + 2 * padding <= pageSize && height + 2 * padding <= pageSize;
+		if (group.second.size() == 1 && fitsPage)
+		{
+			atlasImages.push_back(group.second[0]);
+			continue;
+		}
+
+		GLuint texture = createArray(width, height, (int)group.second.size(), GL_REPEAT);
+		for (int layer = 0; layer < (int)group.second.size(); layer++)
+		{
+			const int index = group.second[layer];
+			uploadLayer(width, height, layer, images[index].rgba.data());
+			materials[index].texture = texture;
+			materials[index].layer = layer;
+			materials[index].rect = glm::vec4(0.f, 0.f, 1.f, 1.f);
+		}
+		textures.push_back(texture);
+	}
+
+	if (!atlasImages.empty())
+	{
+		std::vector<Placement> placements;
+		int pageCount = 0;
+		packPages(atlasImages, pageSize, padding, placements, pageCount);
+
+		// Each page is built on the CPU, borders included, then goes up in one call.
+		GLuint texture = createArray(pageSize, pageSize, pageCount, GL_CLAMP_TO_EDGE);
+		std::vector<unsigned char> page((size_t)pageSize * pageSize * 4);
+		for (int p = 0; p < pageCount; p++)
+		{
+			std::fill(page.begin(), page.end(), (unsigned char)0);
+			for (size_t k = 0; k < atlasImages.size(); k++)
+			{
+				if (placements[k].page != p) continue;
+				const int index = atlasImages[k];
+				const Image& image = images[index];
+				// Rows and columns past the image edge repeat the edge texel, which is what clamping would have sampled.
+				for (int y = -padding; y < image.height + padding; y++)
+				{
+					const int sourceY = std::min(std::max(y, 0), image.height - 1);
+					for (int x = -padding; x < image.width + padding; x++)
+					{
+						const int sourceX = std::min(std::max(x, 0), image.width - 1);
+						const unsigned char* source = &image.rgba[((size_t)sourceY * image.width + sourceX) * 4];
+						unsigned char* target = &page[((size_t)(placements[k].y + y) * pageSize + placements[k].x + x) * 4];
+						memcpy(target, source, 4);
+					}
+				}
+
+				materials[index].texture = texture;
+				materials[index].layer = p;
+				materials[index].rect = glm::vec4((float)placements[k].x / pageSize, (float)placements[k].y / pageSize,
+					(float)image.width / pageSize, (float)image.height / pageSize);
+			}
+			uploadLayer(pageSize, pageSize, p, page.data());
+		}
+		textures.push_back(texture);
+	}
+	glState.bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	std::cout << "Packed " << images.size() << " material textures into " << textures.size() << " texture arrays\n";
+	// The pixels live on the GPU now.
+	for (Image& image : images)
+	{
+		std::vector<unsigned char>().swap(image.rgba);
+	}
+	return success;
+}
+
+// Shelf packing. Tallest first, left to right along a shelf, and a new shelf (or page) when the current one is full.
+// Positions are the top left of the image itself, the padding is around it.
+void MaterialAtlas::packPages(const std::vector<int>& atlasImages, int pageSize, int padding, std::vector<Placement>& placements, int& pageCount) const
+{
+	std::vector<size_t> order(atlasImages.size());
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		order[k] = k;
+	}
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+	{
+		return images[atlasImages[a]].height > images[atlasImages[b]].height;
+	});
+
+	// Cells are rounded up to the padding, so every image starts on a multiple of it and lines up with the coarser mip texel grids.
+	// Without padding there is nothing to line up with, and each cell is exactly its image.
+	const int alignment = std::max(padding, 1);
+	auto roundUp = [alignment](int value)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	};
+
+	placements.assign(atlasImages.size(), Placement());
+	pageCount = 1;
+	int shelfX = 0;
+	int shelfY = 0;
+	int shelfHeight = 0;
+	for (size_t k : order)
+	{
+		const Image& image = images[atlasImages[k]];
+		const int cellWidth = roundUp(image.width + 2 * padding);
+		const int cellHeight = roundUp(image.height + 2 * padding);
+		if (shelfX + cellWidth > pageSize)
+		{
+			shelfX = 0;
+			shelfY += shelfHeight;
+			shelfHeight = 0;
+		}
+		if (shelfY + cellHeight > pageSize)
+		{
+			pageCount++;
+			shelfX = 0;
+			shelfY = 0;
+			shelfHeight = 0;
+		}
+		placements[k].page = pageCount - 1;
+		placements[k].x = shelfX + padding;
+		placements[k].y = shelfY + padding;
+		shelfX += cellWidth;
+		shelfHeight = std::max(shelfHeight, cellHeight);
+	}
+}
+
+GLuint MaterialAtlas::createArray(int width, int height, int layers, GLenum wrap) const
+{
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	glState.bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// Every level is allocated up front, uploadLayer fills them in.
+	const uint32_t levelCount = fullMipCount((uint32_t)width, (uint32_t)height);
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, GL_RGBA8, std::max(width >> i, 1), std::max(height >> i, 1), layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (GLint)levelCount - 1);
+	return texture;
+}
+
+// Builds the layer's mip chain on the thread pool and uploads every level of it into the bound array.
+void MaterialAtlas::uploadLayer(int width, int height, int layer, const unsigned char* rgba) const
+{
+	std::vector<std::vector<unsigned char>> levels;
+	buildMipChain(&pool, rgba, (uint32_t)width, (uint32_t)height, 4, MipOptions(), levels);
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, 0, 0, layer, std::max(width >> i, 1), std::max(height >> i, 1), 1, GL_RGBA, GL_UNSIGNED_BYTE, levels[i].data());
+	}
+}
+
+const MaterialTexture& MaterialAtlas::get(int material) const
+{
+	return materials[material];
+}
+
+size_t MaterialAtlas::textureCount() const
+{
+	return textures.size();
+}
+
+void MaterialAtlas::destroy()
+{
+	if (!textures.empty())
+	{
+		glDeleteTextures((GLsizei)textures.size(), textures.data());
+	}
+	textures.clear();
+	glState.invalidate();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "ThreadPool.h"
+
+// Where one material's image ended up. Everything is a layer of a GL_TEXTURE_2D_ARRAY, so a shader samples
+// texture at vec3(uv * rect.zw + rect.xy, layer). rect is (0, 0, 1, 1) for an image that has a whole layer to itself.
+// Materials share samplers, so the wrap mode can't be a texture parameter. The shader applies it to uv itself (see simpleFrag.glsl).
+struct MaterialTexture
+{
+	GLuint texture = 0;
+	int layer = 0;
+	glm::vec4 rect = glm::vec4(0.f, 0.f, 1.f, 1.f);
+	bool repeat = true;
+};
+
+// Packs material images into as few textures as possible, so objects with different materials can share a bind and a draw call.
+// Images that share their size with at least one other image become the layers of one texture array for that size.
+// The rest are shelf packed into square atlas pages, which are the layers of one more array. Every atlas entry gets a border of
+// repeated edge texels and starts on a multiple of the padding, so the first few mip levels never blend neighbouring entries.
+// Anything too big for a page gets an array of its own.
+class MaterialAtlas
+{
+public:
+	explicit MaterialAtlas(ThreadPool& pool);
+
+	// Returns the material index. Nothing is read until build(). wrap is GL_REPEAT or one of the clamp modes, which all clamp to the edge.
+	int add(const std::string& path, GLenum wrap = GL_REPEAT);
+	// Decodes every added image on the thread pool, packs and uploads. Returns false if any image failed to load (it keeps a grey texel).
+	bool build(int pageSize = 1024, int padding = 8);
+	const MaterialTexture& get(int material) const;
+	size_t textureCount() const;
+	void destroy();
+
+private:
+	struct Image
+	{
+		std::string path;
+		int width = 0;
+		int height = 0;
+		std::vector<unsigned char> rgba;
+	};
+
+	struct Placement
+	{
+		int page;
+		int x;
+		int y;
+	};
+
+	void packPages(const std::vector<int>& images, int pageSize, int padding, std::vector<Placement>& placements, int& pageCount) const;
+	GLuint createArray(int width, int height, int layers, GLenum wrap) const;
+	void uploadLayer(int width, int height, int layer, const unsigned char* rgba) const;
+
+	ThreadPool& pool;
+	std::vector<Image> images;
+	std::vector<MaterialTexture> materials;
+	std::vector<GLuint> textures;
+};
@@ -0,0 +1,273 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include "helpers.h"
+
+namespace
+{
+	struct VertexHash
+	{
+		size_t operator()(const Vertex& v) const
+		{
+			return (size_t)fnv1a(&v, sizeof(Vertex));
+		}
+	};
+
+	struct VertexEqual
+	{
+		bool operator()(const Vertex& a, const Vertex& b) const
+		{
+			return memcmp(&a, &b, sizeof(Vertex)) == 0;
+		}
+	};
+
+	// Tipsify's pick for the next fanning vertex. Among the vertices the last fan touched, the one that entered the cache earliest
+	// but will still be in it after its remaining triangles are emitted. Falls back to the dead end stack, then to the next vertex in input order.
+	int nextVertex(const std::vector<uint32_t>& candidates, const std::vector<int>& cacheTime, int time, const std::vector<uint32_t>& liveTriangles,
+		std::vector<uint32_t>& deadEnds, size_t& cursor, int cacheSize, bool& deadEnd)
+	{
+		int best = -1;
+		int bestPriority = -1;
+		for (uint32_t v : candidates)
+		{
+			if (liveTriangles[v] == 0) continue;
+			int priority = 0;
+			if (time - cacheTime[v] + 2 * (int)liveTriangles[v] <= cacheSize)
+			{
+				priority = time - cacheTime[v];
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				best = (int)v;
+			}
+		}
+		if (best >= 0)
+		{
+			deadEnd = false;
+			return best;
+		}
+
+		deadEnd = true;
+		while (!deadEnds.empty())
+		{
+			uint32_t v = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveTriangles[v] > 0) return (int)v;
+		}
+		while (cursor < liveTriangles.size())
+		{
+			if (liveTriangles[cursor] > 0) return (int)cursor++;
+			cursor++;
+		}
+		return -1;
+	}
+}
+
+void weldVertices(MeshData& mesh)
+{
+	std::unordered_map<Vertex, uint32_t, VertexHash, VertexEqual> unique;
+	unique.reserve(mesh.vertices.size());
+	std::vector<Vertex> welded;
+	std::vector<uint32_t> remap(mesh.vertices.size());
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		auto inserted = unique.insert(std::make_pair(mesh.vertices[i], (uint32_t)welded.size()));
+		if (inserted.second)
+		{
+			welded.push_back(mesh.vertices[i]);
+		}
+		remap[i] = inserted.first->second;
+	}
+
+	for (uint32_t& index : mesh.indices)
+	{
+		index = remap[index];
+	}
+	mesh.vertices.swap(welded);
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize, std::vector<size_t>& clusterStarts)
+{
+	clusterStarts.clear();
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return;
+
+	// Triangles around each vertex, as one flat array with an offset per vertex.
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	for (uint32_t index : indices)
+	{
+		liveTriangles[index]++;
+	}
+	std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		adjacencyStart[v + 1] = adjacencyStart[v] + liveTriangles[v];
+	}
+	std::vector<uint32_t> adjacency(indices.size());
+	std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			adjacency[fill[indices[t * 3 + k]]++] = (uint32_t)t;
+		}
+	}
+
+	std::vector<int> cacheTime(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	int time = cacheSize + 1;
+	size_t cursor = 0;
+	bool deadEnd = true;
+
+	int fan = 0;
+	while (fan >= 0)
+	{
+		if (deadEnd && (clusterStarts.empty() || clusterStarts.back() != output.size()))
+		{
+			clusterStarts.push_back(output.size());
+		}
+
+		candidates.clear();
+		for (uint32_t a = adjacencyStart[fan]; a < adjacencyStart[fan + 1]; a++)
+		{
+			uint32_t t = adjacency[a];
+			if (emitted[t]) continue;
+			emitted[t] = true;
+
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t v = indices[t * 3 + k];
+				output.push_back(v);
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+				// Not in the cache any more (or never was), so this is a miss and it goes in at the back.
+				if (time - cacheTime[v] > cacheSize)
+				{
+					cacheTime[v] = time++;
+				}
+			}
+		}
+		fan = nextVertex(candidates, cacheTime, time, liveTriangles, deadEnds, cursor, cacheSize, deadEnd);
+	}
+	indices.swap(output);
+}
+
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, const std::vector<size_t>& clusterStarts)
+{
+	if (clusterStarts.size() < 2) return;
+
+	struct Cluster
+	{
+		size_t begin;
+		size_t end;
+		float sortKey;
+	};
+
+	glm::vec3 meshCenter(0.f);
+	for (const Vertex& v : vertices)
+	{
+		meshCenter += v.position;
+	}
+	meshCenter /= (float)vertices.size();
+
+	// Area weighted center and normal per cluster. The cross products are already scaled by twice the area, so summing them weights by area for free.
+	std::vector<Cluster> clusters;
+	for (size_t c = 0; c < clusterStarts.size(); c++)
+	{
+		Cluster cluster;
+		cluster.begin = clusterStarts[c];
+		cluster.end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : indices.size();
+
+		glm::vec3 center(0.f);
+		glm::vec3 normal(0.f);
+		float area = 0.f;
+		for (size_t i = cluster.begin; i < cluster.end; i += 3)
+		{
+			const glm::vec3& a = vertices[indices[i]].position;
+			const glm::vec3& b = vertices[indices[i + 1]].position;
+			const glm::vec3& c2 = vertices[indices[i + 2]].position;
+			glm::vec3 n = glm::cross(b - a, c2 - a);
+			float triangleArea = glm::length(n);
+			center += (a + b + c2) / 3.f * triangleArea;
+			normal += n;
+			area += triangleArea;
+		}
+		center = area > 0.f ? center / area : center;
+		normal = area > 0.f ? glm::normalize(normal) : normal;
+		cluster.sortKey = glm::dot(center - meshCenter, normal);
+		clusters.push_back(cluster);
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b)
+	{
+		return a.sortKey > b.sortKey;
+	});
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (const Cluster& cluster : clusters)
+	{
+		output.insert(output.end(), indices.begin() + cluster.begin, indices.begin() + cluster.end);
+	}
+	indices.swap(output);
+}
+
+void optimizeVertexFetch(MeshData& mesh)
+{
+	const uint32_t unused = 0xffffffffu;
+	std::vector<uint32_t> remap(mesh.vertices.size(), unused);
+	std::vector<Vertex> ordered;
+	ordered.reserve(mesh.vertices.size());
+	for (uint32_t& index : mesh.indices)
+	{
+		if (remap[index] == unused)
+		{
+			remap[index] = (uint32_t)ordered.size();
+			ordered.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+	// Vertices no triangle uses are dropped here.
+	mesh.vertices.swap(ordered);
+}
+
+float computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize)
+{
+	if (indices.size() < 3) return 0.f;
+
+	// The same FIFO model Tipsify optimizes for. A vertex is in the cache if it was last missed fewer than cacheSize misses ago.
+	std::vector<int> cacheTime(vertexCount, -cacheSize - 1);
+	int misses = 0;
+	for (uint32_t index : indices)
+	{
+		if (misses - cacheTime[index] > cacheSize)
+		{
+			cacheTime[index] = misses++;
+		}
+	}
+	return (float)misses / (float)(indices.size() / 3);
+}
+
+MeshStats optimizeMesh(MeshData& mesh)
+{
+	MeshStats stats;
+	stats.verticesBefore = mesh.vertices.size();
+	stats.acmrBefore = computeACMR(mesh.indices, mesh.vertices.size(), vertexCacheSize);
+
+	std::vector<size_t> clusterStarts;
+	weldVertices(mesh);
+	optimizeVertexCache(mesh.indices, mesh.vertices.size(), vertexCacheSize, clusterStarts);
+	optimizeOverdraw(mesh.indices, mesh.vertices, clusterStarts);
+	optimizeVertexFetch(mesh);
+
+	stats.verticesAfter = mesh.vertices.size();
+	stats.acmrAfter = computeACMR(mesh.indices, mesh.vertices.size(), vertexCacheSize);
+	return stats;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "GeometryArena.h"
+
+// What optimizeMesh did to a mesh. ACMR is the average number of vertex shader runs per triangle with a FIFO post-transform cache.
+// 3 means nothing is ever reused, a closed grid-like mesh can get close to 0.5.
+struct MeshStats
+{
+	size_t verticesBefore = 0;
+	size_t verticesAfter = 0;
+	float acmrBefore = 0.f;
+	float acmrAfter = 0.f;
+};
+
+const int vertexCacheSize = 16;
+
+// Merges vertices that are bit for bit identical and points the indices at the survivor.
+void weldVertices(MeshData& mesh);
+// Tipsify (Sander et al. 2007). Fans around vertices that are still in the cache, and only jumps somewhere else when the fan runs dry.
+// Fills clusterStarts with the index offsets where the order ran into a dead end, which is where optimizeOverdraw may cut it.
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize, std::vector<size_t>& clusterStarts);
+// Reorders the clusters so the ones facing away from the mesh center come first. Those tend to occlude the rest, so fewer pixels get shaded twice.
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, const std::vector<size_t>& clusterStarts);
+// Renumbers vertices in the order the indices first use them, so the vertex fetch walks through memory front to back.
+void optimizeVertexFetch(MeshData& mesh);
+float computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize);
+
+// Everything above in order. Every mesh built in Meshes.cpp goes through this before it reaches the arena.
+MeshStats optimizeMesh(MeshData& mesh);
@@ -0,0 +1,144 @@
+#include "Meshes.h"
+#include <iomanip>
+#include <iostream>
+#include "MeshOptimizer.h"
+
+MeshData meshFromFloats(const char* name, const float* data, size_t floatCount, int stride, int colorOffset, int texCoordOffset, const uint32_t* indices, size_t indexCount)
+{
+	MeshData mesh;
+	const size_t vertexCount = floatCount / stride;
+	mesh.vertices.resize(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const float* v = data + i * stride;
+		Vertex& vertex = mesh.vertices[i];
+		vertex.position = glm::vec3(v[0], v[1], v[2]);
+		if (colorOffset >= 0) vertex.color = glm::vec3(v[colorOffset], v[colorOffset + 1], v[colorOffset + 2]);
+		if (texCoordOffset >= 0) vertex.texCoord = glm::vec2(v[texCoordOffset], v[texCoordOffset + 1]);
+	}
+
+	if (indices != nullptr)
+	{
+		mesh.indices.assign(indices, indices + indexCount);
+	}
+	else
+	{
+		mesh.indices.resize(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			mesh.indices[i] = (uint32_t)i;
+		}
+	}
+
+	MeshStats stats = optimizeMesh(mesh);
+	std::cout << std::fixed << std::setprecision(2) << "Mesh " << name << ": " << stats.verticesBefore << " -> " << stats.verticesAfter
+		<< " vertices, ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter << '\n' << std::defaultfloat;
+	return mesh;
+}
+
+MeshData triangleMesh()
+{
+	const float vertices[] = {
+		-0.5f, -0.5f, 0.0f,
+		 0.5f, -0.5f, 0.0f,
+		 0.0f,  0.5f, 0.0f
+	};
+	return meshFromFloats("triangle", vertices, sizeof(vertices) / sizeof(float), 3, -1, -1);
+}
+
+MeshData rectangleMesh(float texScale, float offset)
+{
+	const float vertices[] = {
+		// positions          // colors           // texture coords
+		 0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   texScale + offset, texScale + offset,   // top right
+		 0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   texScale + offset, offset,   // bottom right
+		-0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   offset, offset,   // bottom left
+		-0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   offset, texScale + offset    // top left 
+	};
+	const uint32_t indices[] = {
+		0, 1, 2,
+		0, 2, 3
+	};
+	return meshFromFloats("rectangle", vertices, sizeof(vertices) / sizeof(float), 8, 3, 6, indices, 6);
+}
+
+MeshData twoTrianglesMesh()
+{
+	const float vertices[] = {
+		-0.5f, -0.5f, 0.f, // bot left
+		-0.5f, 0.5f, 0.f, // up left
+		0.5f, 0.5f, 0.f, // up right
+		-0.5f, -0.5f, 0.f, // bot left
+		0.5f, 0.5f, 0.f, // up right
+		0.5f, -0.5f, 0.f //bot right 
+	};
+	return meshFromFloats("twoTriangles", vertices, sizeof(vertices) / sizeof(float), 3, -1, -1);
+}
+
+MeshData triangleTwoMesh()
+{
+	const float vertices[] = {
+		-0.5f, -0.5f, 0.f,
+		0.5f, 0.5f, 0.f,
+		0.5f, -0.5f, 0.f
+	};
+	return meshFromFloats("triangleTwo", vertices, sizeof(vertices) / sizeof(float), 3, -1, -1);
+}
+
+MeshData triangleWithTexCoordMesh()
+{
+	const float vertices[] = {
+		-0.5f, -0.5f, 0.0f, 1.f, 0.f, 0.f, 0.f, 0.f,
+		 0.5f, -0.5f, 0.0f, 0.f, 1.f, 0.f, 1.f, 0.f,
+		 0.0f,  0.5f, 0.0f, 0.f, 0.f, 1.f, 0.5f, 1.f
+	};
+	return meshFromFloats("triangleWithTexCoord", vertices, sizeof(vertices) / sizeof(float), 8, 3, 6);
+}
+
+MeshData boxMesh()
+{
+	const float vertices[] = {
+	   -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+	   -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+	   -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+	   -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+	   -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+	   -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+	   -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+	   -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+	   -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+	   -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+	   -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+	   -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+	   -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+	   -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+	   -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+	   -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+	   -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+	   -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+	return meshFromFloats("box", vertices, sizeof(vertices) / sizeof(float), 5, -1, 3);
+}
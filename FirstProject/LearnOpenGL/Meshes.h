@@ -0,0 +1,17 @@
+#pragma once
+
+#include "GeometryArena.h"
+
+// The shapes from the get*VAO functions in main.cpp, converted to the arena's shared vertex format so they can all live in one GeometryArena.
+// Attributes a shape doesn't have are left at zero.
+MeshData triangleMesh();
+MeshData rectangleMesh(float texScale, float texOffset);
+MeshData twoTrianglesMesh();
+MeshData triangleTwoMesh();
+MeshData triangleWithTexCoordMesh();
+MeshData boxMesh();
+
+// Builds a mesh out of an interleaved float array like the ones the tutorial uses. Pass -1 for an attribute the array doesn't have.
+// With no indices, every vertex is used once in order, like glDrawArrays would.
+// The result is welded and reordered by optimizeMesh, and the before/after numbers are printed under name.
+MeshData meshFromFloats(const char* name, const float* data, size_t floatCount, int stride, int colorOffset, int texCoordOffset, const uint32_t* indices = nullptr, size_t indexCount = 0);
@@ -0,0 +1,339 @@
+#include "MipChain.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "ThreadPool.h"
+
+#if defined(__AVX2__)
+#define MIPS_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIPS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	const int maxTaps = 8;
+
+	// Source texel i contributes weights[i - first] to destination texel x, for i from 2x + first to 2x + first + count - 1.
+	struct Kernel
+	{
+		int first = 0;
+		int count = 0;
+		float weights[maxTaps] = {};
+	};
+
+	double besselI0(double x)
+	{
+		// The power series converges quickly for the small arguments a window needs.
+		double sum = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 20; k++)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return sum;
+	}
+
+	Kernel makeKernel(MipFilter filter)
+	{
+		Kernel kernel;
+		if (filter == MipFilter::Box)
+		{
+			kernel.first = 0;
+			kernel.count = 2;
+			kernel.weights[0] = 0.5f;
+			kernel.weights[1] = 0.5f;
+			return kernel;
+		}
+
+		// Destination texel x sits halfway between source texels 2x and 2x + 1, so the taps are 0.5, 1.5, 2.5 and 3.5 texels away on either side.
+		// Halving the resolution puts the cutoff at half the source frequency, hence sinc(d / 2). The window is 4 texels wide on each side, alpha 4.
+		const double pi = 3.14159265358979323846;
+		const double alpha = 4.0;
+		const double halfWidth = 4.0;
+		kernel.first = -3;
+		kernel.count = maxTaps;
+		double total = 0.0;
+		double weights[maxTaps];
+		for (int k = 0; k < maxTaps; k++)
+		{
+			const double d = k - 3.5;
+			const double x = pi * d / 2.0;
+			const double sinc = std::sin(x) / x;
+			const double r = d / halfWidth;
+			const double window = besselI0(alpha * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(alpha);
+			weights[k] = sinc * window;
+			total += weights[k];
+		}
+		for (int k = 0; k < maxTaps; k++)
+		{
+			kernel.weights[k] = (float)(weights[k] / total);
+		}
+		return kernel;
+	}
+
+	const int encodeBuckets = 4096;
+
+	struct SrgbTables
+	{
+		float toLinear[256];
+		// thresholds[i] is the linear value that encodes to exactly i + 0.5. Anything at or above it rounds to a code above i.
+		// The extra entry past the end stops the search in encode() without a bounds check.
+		float thresholds[256];
+		// The code for the bottom of each of encodeBuckets equal slices of [0, 1]. The slices are narrower than the gap between
+		// any two thresholds, so the right code is at most a step or two above the bucket's.
+		unsigned char bucketCodes[encodeBuckets + 1];
+
+		SrgbTables()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				toLinear[i] = decode(i / 255.0);
+			}
+			for (int i = 0; i < 255; i++)
+			{
+				thresholds[i] = decode((i + 0.5) / 255.0);
+			}
+			thresholds[255] = 2.f;
+			int code = 0;
+			for (int bucket = 0; bucket <= encodeBuckets; bucket++)
+			{
+				const float bottom = (float)bucket / encodeBuckets;
+				while (bottom >= thresholds[code]) code++;
+				bucketCodes[bucket] = (unsigned char)code;
+			}
+		}
+
+		// Exact rounding to the nearest code, with no pow.
+		unsigned char encode(float linear) const
+		{
+			int code = bucketCodes[(int)(linear * encodeBuckets)];
+			while (linear >= thresholds[code]) code++;
+			return (unsigned char)code;
+		}
+
+		static float decode(double encoded)
+		{
+			return (float)(encoded <= 0.04045 ? encoded / 12.92 : std::pow((encoded + 0.055) / 1.055, 2.4));
+		}
+	};
+
+	const SrgbTables& srgbTables()
+	{
+		static const SrgbTables tables;
+		return tables;
+	}
+
+	// out[i] = sum of weights[k] * rows[k][i]. The rows are contiguous, so this is a straight run of multiply-adds whatever the channel count.
+	void filterRows(const float* const* rows, const float* weights, int count, float* out, size_t n)
+	{
+		size_t i = 0;
+#ifdef MIPS_AVX2
+		for (; i + 8 <= n; i += 8)
+		{
+			__m256 acc = _mm256_mul_ps(_mm256_set1_ps(weights[0]), _mm256_loadu_ps(rows[0] + i));
+			for (int k = 1; k < count; k++)
+			{
+				acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(rows[k] + i)));
+			}
+			_mm256_storeu_ps(out + i, acc);
+		}
+#endif
+#ifdef MIPS_SSE2
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128 acc = _mm_mul_ps(_mm_set1_ps(weights[0]), _mm_loadu_ps(rows[0] + i));
+			for (int k = 1; k < count; k++)
+			{
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+			}
+			_mm_storeu_ps(out + i, acc);
+		}
+#endif
+		for (; i < n; i++)
+		{
+			float acc = weights[0] * rows[0][i];
+			for (int k = 1; k < count; k++)
+			{
+				acc += weights[k] * rows[k][i];
+			}
+			out[i] = acc;
+		}
+	}
+
+	// Decimates one row horizontally. With four channels a texel is exactly one SSE register (two texels one AVX register).
+	// An RGB texel is loaded and stored as four floats too, the fourth being the next texel's red. Loads can read one float past the row,
+	// so src needs that much slack. Stores write into the next destination texel, which is overwritten with its own value right after,
+	// except past the last one, so that one goes through the scalar loop. One and two channel images take the scalar loop throughout.
+	void filterColumns(const float* src, uint32_t srcWidth, int channels, const Kernel& kernel, float* dst, uint32_t dstWidth)
+	{
+		const int last = (int)srcWidth - 1;
+		uint32_t x = 0;
+#ifdef MIPS_SSE2
+		if (channels == 3)
+		{
+			for (; x + 1 < dstWidth; x++)
+			{
+				__m128 acc = _mm_setzero_ps();
+				for (int k = 0; k < kernel.count; k++)
+				{
+					const int i = std::min(std::max((int)(2 * x) + kernel.first + k, 0), last);
+					acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(kernel.weights[k]), _mm_loadu_ps(src + i * 3)));
+				}
+				_mm_storeu_ps(dst + x * 3, acc);
+			}
+		}
+#endif
+		if (channels == 4)
+		{
+#ifdef MIPS_AVX2
+			for (; x + 2 <= dstWidth; x += 2)
+			{
+				__m256 acc = _mm256_setzero_ps();
+				for (int k = 0; k < kernel.count; k++)
+				{
+					const int i0 = std::min(std::max((int)(2 * x) + kernel.first + k, 0), last);
+					const int i1 = std::min(std::max((int)(2 * x + 2) + kernel.first + k, 0), last);
+					const __m256 texels = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + i0 * 4)), _mm_loadu_ps(src + i1 * 4), 1);
+					acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(kernel.weights[k]), texels));
+				}
+				_mm256_storeu_ps(dst + x * 4, acc);
+			}
+#endif
+#ifdef MIPS_SSE2
+			for (; x < dstWidth; x++)
+			{
+				__m128 acc = _mm_setzero_ps();
+				for (int k = 0; k < kernel.count; k++)
+				{
+					const int i = std::min(std::max((int)(2 * x) + kernel.first + k, 0), last);
+					acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(kernel.weights[k]), _mm_loadu_ps(src + i * 4)));
+				}
+				_mm_storeu_ps(dst + x * 4, acc);
+			}
+#endif
+		}
+		for (; x < dstWidth; x++)
+		{
+			float acc[4] = { 0.f, 0.f, 0.f, 0.f };
+			for (int k = 0; k < kernel.count; k++)
+			{
+				const int i = std::min(std::max((int)(2 * x) + kernel.first + k, 0), last);
+				for (int c = 0; c < channels; c++)
+				{
+					acc[c] += kernel.weights[k] * src[i * channels + c];
+				}
+			}
+			for (int c = 0; c < channels; c++)
+			{
+				dst[x * channels + c] = acc[c];
+			}
+		}
+	}
+
+	// Splits count rows into a few blocks per thread, so one slow block doesn't leave the other threads idle at the end of a level.
+	void forRowBlocks(ThreadPool* pool, uint32_t count, const std::function<void(uint32_t, uint32_t)>& job)
+	{
+		const uint32_t threads = pool != nullptr ? pool->size() + 1 : 1;
+		const uint32_t blocks = std::min(count, threads * 4);
+		const uint32_t rowsPerBlock = (count + blocks - 1) / blocks;
+		auto runBlock = [&](size_t block)
+		{
+			const uint32_t begin = (uint32_t)block * rowsPerBlock;
+			const uint32_t end = std::min(begin + rowsPerBlock, count);
+			if (begin < end) job(begin, end);
+		};
+		if (pool != nullptr && blocks > 1)
+		{
+			pool->parallelFor(blocks, runBlock);
+		}
+		else
+		{
+			for (uint32_t block = 0; block < blocks; block++) runBlock(block);
+		}
+	}
+}
+
+void buildMipChain(ThreadPool* pool, const unsigned char* pixels, uint32_t width, uint32_t height, int channels, const MipOptions& options,
+	std::vector<std::vector<unsigned char>>& levels)
+{
+	levels.clear();
+	if (width == 0 || height == 0 || channels < 1 || channels > 4) return;
+
+	const Kernel kernel = makeKernel(options.filter);
+	// Which channels go through the sRGB curve. Alpha, and images too narrow to be colour, stay linear.
+	bool srgb[4] = { false, false, false, false };
+	for (int c = 0; c < std::min(channels, 3); c++)
+	{
+		srgb[c] = options.srgb && channels >= 3;
+	}
+	const SrgbTables& tables = srgbTables();
+
+	const size_t rowFloats = (size_t)width * channels;
+	levels.emplace_back(pixels, pixels + rowFloats * height);
+
+	// Every level is filtered from the float version of the one above it, so rounding to 8 bits never accumulates down the chain.
+	std::vector<float> current(rowFloats * height);
+	forRowBlocks(pool, height, [&](uint32_t begin, uint32_t end)
+	{
+		for (size_t i = begin * rowFloats; i < end * rowFloats; i += channels)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				current[i + c] = srgb[c] ? tables.toLinear[pixels[i + c]] : pixels[i + c] * (1.f / 255.f);
+			}
+		}
+	});
+
+	uint32_t srcWidth = width;
+	uint32_t srcHeight = height;
+	std::vector<float> next;
+	while (srcWidth > 1 || srcHeight > 1)
+	{
+		const uint32_t dstWidth = std::max(srcWidth / 2, 1u);
+		const uint32_t dstHeight = std::max(srcHeight / 2, 1u);
+		const size_t srcRowFloats = (size_t)srcWidth * channels;
+		const size_t dstRowFloats = (size_t)dstWidth * channels;
+		next.resize(dstRowFloats * dstHeight);
+		std::vector<unsigned char> level(dstRowFloats * dstHeight);
+
+		// A dimension that is already 1 is copied through. Every tap clamps to the same row or column, and the weights sum to one.
+		forRowBlocks(pool, dstHeight, [&](uint32_t begin, uint32_t end)
+		{
+			std::vector<float> column(srcRowFloats + 1); // The slack filterColumns reads RGB with.
+			const float* rows[maxTaps];
+			for (uint32_t y = begin; y < end; y++)
+			{
+				for (int k = 0; k < kernel.count; k++)
+				{
+					const int row = std::min(std::max((int)(2 * y) + kernel.first + k, 0), (int)srcHeight - 1);
+					rows[k] = current.data() + (size_t)row * srcRowFloats;
+				}
+				filterRows(rows, kernel.weights, kernel.count, column.data(), srcRowFloats);
+				float* dstRow = next.data() + (size_t)y * dstRowFloats;
+				filterColumns(column.data(), srcWidth, channels, kernel, dstRow, dstWidth);
+
+				// The Kaiser kernel's negative lobes can overshoot. Clamping the float copy as well keeps the ringing from feeding into the next level.
+				unsigned char* out = level.data() + (size_t)y * dstRowFloats;
+				for (size_t i = 0; i < dstRowFloats; i += channels)
+				{
+					for (int c = 0; c < channels; c++)
+					{
+						const float value = std::min(std::max(dstRow[i + c], 0.f), 1.f);
+						dstRow[i + c] = value;
+						out[i + c] = srgb[c] ? tables.encode(value) : (unsigned char)(value * 255.f + 0.5f);
+					}
+				}
+			}
+		});
+
+		levels.push_back(std::move(level));
+		current.swap(next);
+		srcWidth = dstWidth;
+		srcHeight = dstHeight;
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+enum class MipFilter
+{
+	// Averages each 2x2 block. Cheap, and what glGenerateMipmap does on most drivers.
+	Box,
+	// An 8 tap Kaiser windowed sinc. Keeps small mips sharper than the box and aliases less, at the cost of a little ringing,
+	// which is clamped away at the ends of the range.
+	Kaiser,
+};
+
+struct MipOptions
+{
+	MipFilter filter = MipFilter::Box;
+	// Treat the first three channels as sRGB encoded, so they're averaged as linear light and encoded again. Averaging the encoded
+	// values directly darkens every level, most visibly on high contrast detail. Alpha and one or two channel images are always linear.
+	bool srgb = false;
+};
+
+// Builds the full mip chain of an 8 bit per channel image (1 to 4 channels, tightly packed) down to 1x1. levels[0] is a copy of the source.
+// Each level is filtered from the previous one in float, vertically then horizontally, with AVX2 or SSE2 doing the arithmetic when the build
+// targets them (the project builds with /arch:AVX2, SSE2 is the fallback for other compilers and flags). The rows of a level are spread over pool, which can be null to do everything on the calling thread. Calling it from a pool
+// job is fine, parallelFor has the caller take work too, so it can't wait on itself.
+// The result only depends on the input, never on the driver, unlike glGenerateMipmap.
+void buildMipChain(ThreadPool* pool, const unsigned char* pixels, uint32_t width, uint32_t height, int channels, const MipOptions& options,
+	std::vector<std::vector<unsigned char>>& levels);
@@ -0,0 +1,110 @@
+#include "MultiDraw.h"
+#include <cstring>
+#include "GLExtensions.h"
+#include "GLState.h"
+
+void MultiDrawBatch::attach(GLuint vao, GLuint firstLocation)
+{
+	this->vao = vao;
+	instances.attach(vao, firstLocation);
+}
+
+uint32_t MultiDrawBatch::addMesh(const MeshRange& range)
+{
+	meshes.push_back(range);
+	meshCounts.push_back(0);
+	return (uint32_t)meshes.size() - 1;
+}
+
+void MultiDrawBatch::reserve(size_t objectCount)
+{
+	objects.reserve(objectCount);
+	groupedModels.reserve(objectCount);
+	commands.reserve(meshes.size());
+}
+
+void MultiDrawBatch::clear()
+{
+	objects.clear();
+}
+
+void MultiDrawBatch::add(uint32_t meshId, const glm::mat4& model)
+{
+	Object object;
+	object.meshId = meshId;
+	object.model = model;
+	objects.push_back(object);
+}
+
+size_t MultiDrawBatch::commandCount() const
+{
+	return commands.size();
+}
+
+// A counting sort by mesh. One pass counts the objects per mesh, the running sum turns that into each group's first instance,
+// and a second pass drops every matrix into its group. Order inside a group stays the order the objects were added in.
+void MultiDrawBatch::build()
+{
+	for (uint32_t& count : meshCounts)
+	{
+		count = 0;
+	}
+	for (const Object& object : objects)
+	{
+		meshCounts[object.meshId]++;
+	}
+
+	commands.clear();
+	uint32_t first = 0;
+	for (size_t mesh = 0; mesh < meshes.size(); mesh++)
+	{
+		uint32_t count = meshCounts[mesh];
+		meshCounts[mesh] = first; // From here on it's the next free slot of the group.
+		if (count == 0) continue;
+
+		DrawElementsIndirectCommand command;
+		command.count = (GLuint)meshes[mesh].indexCount;
+		command.instanceCount = count;
+		command.firstIndex = meshes[mesh].firstIndex;
+		command.baseVertex = meshes[mesh].baseVertex;
+		command.baseInstance = first;
+		commands.push_back(command);
+		first += count;
+	}
+
+	groupedModels.resize(objects.size());
+	for (const Object& object : objects)
+	{
+		groupedModels[meshCounts[object.meshId]++] = object.model;
+	}
+}
+
+void MultiDrawBatch::submit(RingBuffer& ring)
+{
+	build();
+	if (commands.empty()) return;
+	if (!instances.upload(ring, groupedModels)) return;
+
+	glState.bindVertexArray(vao);
+	if (glExt.multiDrawIndirect)
+	{
+		const size_t size = commands.size() * sizeof(DrawElementsIndirectCommand);
+		RingBuffer::Allocation allocation = ring.map(size, sizeof(GLuint));
+		if (allocation.data == nullptr) return;
+		memcpy(allocation.data, commands.data(), size);
+		ring.unmap(allocation);
+
+		// The indirect pointer is an offset into whatever is bound to GL_DRAW_INDIRECT_BUFFER.
+		glState.bindBuffer(GL_DRAW_INDIRECT_BUFFER, ring.getBuffer());
+		glExt.multiDrawElementsIndirect(GL_TRIANGLES, arenaIndexType, (void*)allocation.offset, (GLsizei)commands.size(), 0);
+		return;
+	}
+
+	// GL 3.3 has no base instance, so the attribute itself is moved to where each group starts.
+	const GLintptr modelsOffset = instances.getOffset();
+	for (const DrawElementsIndirectCommand& command : commands)
+	{
+		instances.pointAttributes(ring.getBuffer(), modelsOffset + command.baseInstance * sizeof(glm::mat4));
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, arenaIndexType, (void*)(command.firstIndex * sizeof(ArenaIndex)), command.instanceCount, command.baseVertex);
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "GeometryArena.h"
+#include "InstanceBuffer.h"
+#include "RingBuffer.h"
+
+// Layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER, one per draw.
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// Draws any mix of arena meshes, each with its own model matrix, in one glMultiDrawElementsIndirect call.
+// Objects are grouped by mesh into one command per mesh. The matrices of a group sit next to each other in the instance buffer,
+// and the command's baseInstance is where the group starts, so every draw reads its own per-object data through the instance attribute.
+//
+// Without multi-draw indirect (plain GL 3.3) the same commands are issued one by one as instanced draws, re-pointing the instance
+// attribute at each group. That is one call per distinct mesh instead of one per object, so it still scales with the number of meshes only.
+class MultiDrawBatch
+{
+public:
+	MultiDrawBatch() = default;
+
+	// vao has to be an arena VAO nothing else uses, the instance matrices go to 4 locations starting at firstLocation.
+	void attach(GLuint vao, GLuint firstLocation);
+	// Returns the id the mesh is added under.
+	uint32_t addMesh(const MeshRange& range);
+	void reserve(size_t objectCount);
+	void clear();
+	void add(uint32_t meshId, const glm::mat4& model);
+	// Builds the commands, uploads commands and matrices through the ring and draws. The caller binds the program and textures.
+	void submit(RingBuffer& ring);
+
+	size_t commandCount() const;
+
+private:
+	struct Object
+	{
+		uint32_t meshId;
+		glm::mat4 model;
+	};
+
+	void build();
+
+	GLuint vao = 0;
+	InstanceBuffer instances;
+	std::vector<MeshRange> meshes;
+	std::vector<Object> objects;
+	std::vector<uint32_t> meshCounts;
+	std::vector<glm::mat4> groupedModels;
+	std::vector<DrawElementsIndirectCommand> commands;
+};
@@ -0,0 +1,104 @@
+#include "ProgramCache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "GLExtensions.h"
+#include "helpers.h"
+
+namespace
+{
+	const uint32_t cacheMagic = 0x50474f4c; // "LOGP"
+	const uint32_t cacheVersion = 1;
+
+	struct CacheHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint32_t binaryFormat;
+		uint32_t length;
+	};
+
+	std::string cachePath(uint64_t key)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+		return std::string(programCacheDirectory) + "/" + name;
+	}
+
+	uint64_t hashGLString(GLenum name, uint64_t hash)
+	{
+		const char* str = (const char*)glGetString(name);
+		return str == nullptr ? hash : fnv1a(str, strlen(str) + 1, hash);
+	}
+}
+
+uint64_t programCacheKey(const std::string& vertSrc, const std::string& fragSrc)
+{
+	// The +1 hashes the terminators too, so "ab" + "c" and "a" + "bc" don't collide.
+	uint64_t hash = fnv1a(vertSrc.c_str(), vertSrc.size() + 1);
+	hash = fnv1a(fragSrc.c_str(), fragSrc.size() + 1, hash);
+	hash = hashGLString(GL_VENDOR, hash);
+	hash = hashGLString(GL_RENDERER, hash);
+	return hashGLString(GL_VERSION, hash);
+}
+
+GLuint loadCachedProgram(uint64_t key)
+{
+	if (!glExt.programBinary) return 0;
+
+	std::ifstream file(cachePath(key), std::ios::binary | std::ios::ate);
+	if (!file) return 0;
+	const std::streamoff fileSize = file.tellg();
+	file.seekg(0);
+
+	CacheHeader header = {};
+	file.read((char*)&header, sizeof(header));
+	if (!file || header.magic != cacheMagic || header.version != cacheVersion || header.key != key) return 0;
+
+	// The binary is the rest of the file. A truncated or corrupt entry is treated as a miss, and linking from source writes a good one over it.
+	if (header.length == 0 || fileSize < 0 || (uint64_t)fileSize - sizeof(header) != header.length) return 0;
+	std::vector<char> binary(header.length);
+	file.read(binary.data(), binary.size());
+	if (!file || file.gcount() != (std::streamsize)binary.size()) return 0;
+
+	GLuint program = glCreateProgram();
+	glExt.programBinaryLoad(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+	// The driver is free to reject a binary it made earlier, so this has to be checked like a normal link.
+	int success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+void saveCachedProgram(uint64_t key, GLuint program)
+{
+	if (!glExt.programBinary) return;
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return;
+
+	std::vector<char> binary(length);
+	GLenum binaryFormat = GL_NONE;
+	glExt.getProgramBinary(program, length, &length, &binaryFormat, binary.data());
+
+	if (!makeDirectory(programCacheDirectory)) return;
+	std::ofstream file(cachePath(key), std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "Could not write program cache entry " << cachePath(key) << '\n';
+		return;
+	}
+
+	CacheHeader header = { cacheMagic, cacheVersion, key, binaryFormat, (uint32_t)length };
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), length);
+}
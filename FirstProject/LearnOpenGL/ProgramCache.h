@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <glad/glad.h>
+
+// An on-disk cache of linked program binaries, so later launches can skip compiling and linking GLSL.
+// Entries are keyed by a hash of the shader sources plus the driver's vendor, renderer and version strings. A driver update changes the key,
+// and the stale entry simply never gets looked up again.
+const char* const programCacheDirectory = "./ShaderCache";
+
+uint64_t programCacheKey(const std::string& vertSrc, const std::string& fragSrc);
+// Returns 0 when there is no usable entry, in which case the program has to be built from source.
+GLuint loadCachedProgram(uint64_t key);
+// The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+void saveCachedProgram(uint64_t key, GLuint program);
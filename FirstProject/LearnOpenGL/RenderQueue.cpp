@@ -0,0 +1,111 @@
+#include "RenderQueue.h"
+#include <iostream>
+#include "GLState.h"
+
+uint64_t makeSortKey(uint32_t programId, uint32_t textureSetId, uint32_t vaoId, float depth01)
+{
+	depth01 = depth01 < 0.f ? 0.f : (depth01 > 1.f ? 1.f : depth01);
+	uint64_t depth = (uint64_t)(depth01 * 0xFFFFFF);
+	return ((uint64_t)(programId & 0xFFF) << 52)
+		| ((uint64_t)(textureSetId & 0xFFF) << 40)
+		| ((uint64_t)(vaoId & 0xFFF) << 28)
+		| (depth << 4);
+}
+
+uint32_t SortKeyIds::get(uint64_t name)
+{
+	auto found = ids.find(name);
+	if (found != ids.end()) return found->second;
+	const uint32_t id = (uint32_t)ids.size();
+	if (id == 0x1000)
+	{
+		std::cout << "More than 4096 distinct states in one sort key field, later ones will share keys with earlier ones\n";
+	}
+	ids.emplace(name, id);
+	return id;
+}
+
+void RenderQueue::reserve(size_t packetCount)
+{
+	packets.reserve(packetCount);
+	items.reserve(packetCount);
+	scratch.reserve(packetCount);
+	order.reserve(packetCount);
+}
+
+// Keeps the capacity, only the contents go.
+void RenderQueue::clear()
+{
+	packets.clear();
+	items.clear();
+	order.clear();
+}
+
+void RenderQueue::push(const DrawPacket& packet)
+{
+	items.push_back({ packet.key, (uint32_t)packets.size() });
+	packets.push_back(packet);
+}
+
+// LSD radix sort, 8 bits per pass. A comparison sort would be O(n log n) and branchy, this is at most 8 linear passes.
+// All eight histograms are counted in one read over the keys. Any byte that is the same in every key (the spare bits, or every packet using
+// one program) would leave the order untouched, so that pass is skipped. Each pass is stable, which keeps submission order for equal keys.
+void RenderQueue::sort()
+{
+	const size_t count = items.size();
+	scratch.resize(count);
+
+	uint32_t histograms[8][256] = {};
+	for (const SortItem& item : items)
+	{
+		for (int byte = 0; byte < 8; byte++)
+		{
+			histograms[byte][(item.key >> (byte * 8)) & 0xFF]++;
+		}
+	}
+
+	for (int byte = 0; byte < 8; byte++)
+	{
+		uint32_t* histogram = histograms[byte];
+		const int shift = byte * 8;
+		if (count == 0 || histogram[(items[0].key >> shift) & 0xFF] == count) continue;
+
+		uint32_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++)
+		{
+			uint32_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+		for (const SortItem& item : items)
+		{
+			scratch[histogram[(item.key >> shift) & 0xFF]++] = item;
+		}
+		items.swap(scratch);
+	}
+
+	order.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		order[i] = items[i].index;
+	}
+}
+
+size_t RenderQueue::size() const
+{
+	return packets.size();
+}
+
+// Neighbouring packets mostly share state after sorting, and glState drops the binds that don't change anything.
+void RenderQueue::bindState(const DrawPacket& packet)
+{
+	glState.useProgram(packet.program);
+	glState.bindVertexArray(packet.vao);
+	glState.bindTextureUnit(0, GL_TEXTURE_2D, packet.textures[0]);
+	glState.bindTextureUnit(1, GL_TEXTURE_2D, packet.textures[1]);
+}
+
+void RenderQueue::draw(const DrawPacket& packet)
+{
+	drawMesh(packet.mesh);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "GeometryArena.h"
+
+// One draw call worth of state. transformIndex points into whatever per-object data the caller keeps, the queue never looks at it.
+struct DrawPacket
+{
+	uint64_t key = 0;
+	GLuint program = 0;
+	GLuint vao = 0;
+	GLuint textures[2] = {};
+	MeshRange mesh;
+	uint32_t transformIndex = 0;
+};
+
+// Packs the state a packet needs into one integer so sorting by it groups packets that share state.
+// From the top bit down: 12 bits program, 12 bits texture set, 12 bits VAO, 24 bits depth, 4 spare. Programs are the most expensive to switch,
+// so they change least often. Depth comes last, so within one batch of identical state the opaque objects go front to back and the depth test
+// throws away as many hidden fragments as possible. Ids are masked to their width, so pass dense ids from SortKeyIds, not GL names.
+uint64_t makeSortKey(uint32_t programId, uint32_t textureSetId, uint32_t vaoId, float depth01);
+
+// Turns GL names into the small dense ids makeSortKey wants. GL hands out names however it likes, so they can be large or far apart,
+// and masking them to 12 bits would make unrelated state collide. Ids count up from 0 in the order names are first seen.
+// Keep one per kind of state (programs, texture sets, VAOs). A texture set is any 64 bit name the caller builds, like two texture names side by side.
+class SortKeyIds
+{
+public:
+	uint32_t get(uint64_t name);
+
+private:
+	std::unordered_map<uint64_t, uint32_t> ids;
+};
+
+// Collects packets for a frame, sorts them by key with a radix sort and submits them with as few state changes as possible.
+// Every buffer is kept between frames, so once it has grown to the largest frame it never allocates again.
+class RenderQueue
+{
+public:
+	RenderQueue() = default;
+
+	void reserve(size_t packetCount);
+	void clear();
+	void push(const DrawPacket& packet);
+	void sort();
+	size_t size() const;
+
+	// Binds state through glState, calls perDraw(packet) so the caller can set per-object uniforms, then issues the draw.
+	template<typename PerDraw>
+	void execute(PerDraw&& perDraw) const
+	{
+		for (uint32_t index : order)
+		{
+			const DrawPacket& packet = packets[index];
+			bindState(packet);
+			perDraw(packet);
+			draw(packet);
+		}
+	}
+
+private:
+	struct SortItem
+	{
+		uint64_t key;
+		uint32_t index;
+	};
+
+	static void bindState(const DrawPacket& packet);
+	static void draw(const DrawPacket& packet);
+
+	std::vector<DrawPacket> packets;
+	std::vector<SortItem> items;
+	std::vector<SortItem> scratch;
+	std::vector<uint32_t> order;
+};
@@ -0,0 +1,118 @@
+#include "RingBuffer.h"
+#include <iostream>
+#include "GLExtensions.h"
+#include "GLState.h"
+
+void RingBuffer::create(size_t bytesPerFrame, int framesInFlight)
+{
+	regionCount = framesInFlight < 1 ? 1 : (framesInFlight > maxFramesInFlight ? maxFramesInFlight : framesInFlight);
+	// Round up so every region starts aligned for any use we might bind it for.
+	regionSize = (bytesPerFrame + 255) & ~(size_t)255;
+	region = 0;
+	head = 0;
+
+	glGenBuffers(1, &buffer);
+	glState.bindBuffer(GL_ARRAY_BUFFER, buffer);
+	const size_t totalSize = regionSize * regionCount;
+	if (glExt.bufferStorage)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glExt.bufferStorageAlloc(GL_ARRAY_BUFFER, totalSize, nullptr, flags);
+		persistent = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize, flags);
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+	}
+	glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Moves on to the next region, first waiting until the GPU is done with what we wrote into it framesInFlight frames ago.
+// Normally that fence signalled long ago and this doesn't wait at all.
+void RingBuffer::beginFrame()
+{
+	GLsync& fence = fences[region];
+	if (fence != nullptr)
+	{
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		while (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED && result != GL_WAIT_FAILED)
+		{
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+	head = 0;
+}
+
+RingBuffer::Allocation RingBuffer::map(size_t size, size_t alignment)
+{
+	Allocation allocation;
+	size_t start = (head + alignment - 1) / alignment * alignment;
+	if (size == 0 || start + size > regionSize)
+	{
+		if (size != 0 && !warnedFull)
+		{
+			std::cout << "Ring buffer region of " << regionSize << " bytes is full, dropping a " << size << " byte allocation\n";
+			warnedFull = true;
+		}
+		return allocation;
+	}
+	head = start + size;
+
+	allocation.offset = (GLintptr)(region * regionSize + start);
+	allocation.size = (GLsizeiptr)size;
+	if (persistent != nullptr)
+	{
+		allocation.data = persistent + allocation.offset;
+	}
+	else
+	{
+		glState.bindBuffer(GL_ARRAY_BUFFER, buffer);
+		allocation.data = glMapBufferRange(GL_ARRAY_BUFFER, allocation.offset, allocation.size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	}
+	return allocation;
+}
+
+// A coherent persistent mapping needs nothing here, the GPU sees the writes once the draw is submitted.
+void RingBuffer::unmap(const Allocation& allocation)
+{
+	if (persistent != nullptr || allocation.data == nullptr) return;
+	glState.bindBuffer(GL_ARRAY_BUFFER, buffer);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+// Call after the last draw that reads from this frame's region has been issued.
+void RingBuffer::endFrame()
+{
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	region = (region + 1) % regionCount;
+}
+
+void RingBuffer::destroy()
+{
+	for (int i = 0; i < maxFramesInFlight; i++)
+	{
+		if (fences[i] != nullptr) glDeleteSync(fences[i]);
+		fences[i] = nullptr;
+	}
+	if (persistent != nullptr)
+	{
+		glState.bindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		persistent = nullptr;
+	}
+	glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+GLuint RingBuffer::getBuffer() const
+{
+	return buffer;
+}
+
+bool RingBuffer::isPersistent() const
+{
+	return persistent != nullptr;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+
+// One GPU buffer split into a region per frame in flight, for data that is rewritten every frame (instance transforms, particles...).
+// Any subsystem can map() a piece of the current frame's region, write into it and point GL at the returned offset. No buffer is ever
+// created, resized or orphaned after create(). A fence per region makes sure we never write over data the GPU hasn't consumed yet.
+//
+// With ARB_buffer_storage the whole buffer stays persistently and coherently mapped, so map() is just pointer arithmetic.
+// Without it each map() is a glMapBufferRange with the unsynchronized and invalidate flags. The fences do the syncing the driver would otherwise do.
+class RingBuffer
+{
+public:
+	struct Allocation
+	{
+		void* data = nullptr;
+		GLintptr offset = 0;
+		GLsizeiptr size = 0;
+	};
+
+	RingBuffer() = default;
+
+	void create(size_t bytesPerFrame, int framesInFlight = 3);
+	void beginFrame();
+	// data is null when the frame's region is out of space. Call unmap() once the data is written, before drawing with it.
+	Allocation map(size_t size, size_t alignment = 16);
+	void unmap(const Allocation& allocation);
+	void endFrame();
+	void destroy();
+
+	GLuint getBuffer() const;
+	bool isPersistent() const;
+
+private:
+	static const int maxFramesInFlight = 4;
+
+	GLuint buffer = 0;
+	unsigned char* persistent = nullptr;
+	size_t regionSize = 0;
+	int regionCount = 0;
+	int region = 0;
+	size_t head = 0;
+	GLsync fences[maxFramesInFlight] = {};
+	bool warnedFull = false;
+};
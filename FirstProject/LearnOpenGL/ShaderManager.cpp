@@ -0,0 +1,184 @@
+#include "ShaderManager.h"
+#include "GLExtensions.h"
+#include "ProgramCache.h"
+
+ShaderManager::~ShaderManager()
+{
+	destroy();
+}
+
+void ShaderManager::destroy()
+{
+	for (Program& program : programs)
+	{
+		if (program.vert != 0) glDeleteShader(program.vert);
+		if (program.frag != 0) glDeleteShader(program.frag);
+		if (program.program != 0) glDeleteProgram(program.program);
+	}
+	programs.clear();
+}
+
+void ShaderManager::add(const std::string& name, const char* vertPath, const char* fragPath, const std::vector<std::string>& defines)
+{
+	Program program;
+	program.name = name;
+	program.vertPath = vertPath;
+	program.fragPath = fragPath;
+	program.defines = defines;
+	programs.push_back(std::move(program));
+}
+
+void ShaderManager::compileAll()
+{
+	if (glExt.parallelShaderCompile)
+	{
+		glExt.maxShaderCompilerThreads(0xFFFFFFFF); // Let the driver use as many threads as it likes.
+	}
+
+	// First pass only issues compiles. Nothing here waits on the driver.
+	for (Program& program : programs)
+	{
+		if (program.state != State::Added) continue;
+		program.state = State::Building;
+
+		std::string vertSrc;
+		std::string fragSrc;
+		if (!readFile(program.vertPath, vertSrc) || !readFile(program.fragPath, fragSrc))
+		{
+			program.state = State::Ready;
+			program.shader.reset(new Shader(0));
+			continue;
+		}
+		vertSrc = injectDefines(vertSrc, program.defines);
+		fragSrc = injectDefines(fragSrc, program.defines);
+
+		program.cacheKey = programCacheKey(vertSrc, fragSrc);
+		GLuint cached = loadCachedProgram(program.cacheKey);
+		if (cached != 0)
+		{
+			program.state = State::Ready;
+			program.program = cached;
+			program.shader.reset(new Shader(cached));
+			continue;
+		}
+
+		const char* vertCStr = vertSrc.c_str();
+		const char* fragCStr = fragSrc.c_str();
+		program.vert = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(program.vert, 1, &vertCStr, nullptr);
+		glCompileShader(program.vert);
+		program.frag = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(program.frag, 1, &fragCStr, nullptr);
+		glCompileShader(program.frag);
+	}
+
+	// Second pass links. Linking a shader that is still compiling is allowed, the driver just chains the work.
+	for (Program& program : programs)
+	{
+		if (program.state != State::Building || program.program != 0) continue;
+
+		program.program = glCreateProgram();
+		glAttachShader(program.program, program.vert);
+		glAttachShader(program.program, program.frag);
+		if (glExt.programBinary)
+		{
+			glExt.programParameteri(program.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+		glLinkProgram(program.program);
+	}
+}
+
+// Finishes whatever programs the driver is done with and returns true once all of them are ready.
+// Without the parallel compile extension there is no way to ask without blocking, so everything is finished on the first call.
+bool ShaderManager::poll()
+{
+	bool allReady = true;
+	for (Program& program : programs)
+	{
+		if (program.state == State::Ready) continue;
+		if (program.state == State::Added)
+		{
+			allReady = false;
+			continue;
+		}
+
+		if (glExt.parallelShaderCompile)
+		{
+			GLint done = GL_FALSE;
+			glGetProgramiv(program.program, GL_COMPLETION_STATUS_KHR, &done);
+			if (!done)
+			{
+				allReady = false;
+				continue;
+			}
+		}
+		complete(program);
+	}
+	return allReady;
+}
+
+// Asking for GL_LINK_STATUS (in complete) blocks until the link is done, so this waits in the driver instead of spinning on poll().
+void ShaderManager::finish()
+{
+	compileAll();
+	for (Program& program : programs)
+	{
+		if (program.state == State::Building) complete(program);
+	}
+}
+
+Shader* ShaderManager::get(const std::string& name) const
+{
+	for (const Program& program : programs)
+	{
+		if (program.name == name) return program.shader.get();
+	}
+	return nullptr;
+}
+
+// Only now do we query status. If the link failed, the compile logs usually say why.
+void ShaderManager::complete(Program& program)
+{
+	program.state = State::Ready;
+
+	int success = 0;
+	glGetProgramiv(program.program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		checkCompilationStatus(program.vert, program.vertPath);
+		checkCompilationStatus(program.frag, program.fragPath);
+		char infoLog[512];
+		glGetProgramInfoLog(program.program, 512, nullptr, infoLog);
+		std::cout << "Could not link shader program " << program.name << " from " << program.vertPath << " and " << program.fragPath << '\n' << infoLog << '\n';
+		glDeleteProgram(program.program);
+		program.program = 0;
+	}
+	else
+	{
+		saveCachedProgram(program.cacheKey, program.program);
+	}
+
+	glDeleteShader(program.vert);
+	glDeleteShader(program.frag);
+	program.vert = 0;
+	program.frag = 0;
+	program.shader.reset(new Shader(program.program));
+}
+
+std::string injectDefines(const std::string& src, const std::vector<std::string>& defines)
+{
+	if (defines.empty()) return src;
+
+	std::string block;
+	for (const std::string& define : defines)
+	{
+		block += "#define " + define + "\n";
+	}
+
+	// Our shader files have comments above #version, so it isn't necessarily the first line.
+	size_t version = src.find("#version");
+	if (version == std::string::npos) return block + src;
+	size_t lineEnd = src.find('\n', version);
+	if (lineEnd == std::string::npos) return src + "\n" + block;
+	return src.substr(0, lineEnd + 1) + block + src.substr(lineEnd + 1);
+}
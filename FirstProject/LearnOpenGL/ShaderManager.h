@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "shader.h"
+
+// Builds a whole set of programs at once instead of one after another.
+// Every program is added up front, optionally with #defines that turn one pair of source files into several variants (permutations).
+// compileAll() then issues every compile and link before checking any of them. Asking for compile status right after glCompileShader
+// forces the driver to finish that shader before it can start the next one, which is what made the Shader constructor slow.
+// With KHR_parallel_shader_compile the driver works on them in the background and poll() just asks which ones are done.
+class ShaderManager
+{
+public:
+	ShaderManager() = default;
+	~ShaderManager();
+
+	ShaderManager(const ShaderManager&) = delete;
+	ShaderManager& operator=(const ShaderManager&) = delete;
+
+	void add(const std::string& name, const char* vertPath, const char* fragPath, const std::vector<std::string>& defines = std::vector<std::string>());
+	void compileAll();
+	bool poll();
+	void finish();
+	// Deletes every program. The manager owns them, so the Shaders get() handed out must not be used after this. Call it before the context goes away.
+	void destroy();
+
+	// Null until the program has finished building. A program that failed to build comes back as an empty Shader, like the Shader constructor does.
+	Shader* get(const std::string& name) const;
+
+private:
+	enum class State
+	{
+		Added,
+		Building,
+		Ready
+	};
+
+	struct Program
+	{
+		std::string name;
+		std::string vertPath;
+		std::string fragPath;
+		std::vector<std::string> defines;
+		State state = State::Added;
+		uint64_t cacheKey = 0;
+		GLuint vert = 0;
+		GLuint frag = 0;
+		GLuint program = 0;
+		std::unique_ptr<Shader> shader;
+	};
+
+	void complete(Program& program);
+
+	std::vector<Program> programs;
+};
+
+// Inserts a #define line for each entry right after the #version line, which has to stay the first directive in the file.
+std::string injectDefines(const std::string& src, const std::vector<std::string>& defines);
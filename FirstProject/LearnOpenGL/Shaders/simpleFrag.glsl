@@ -5,12 +5,37 @@ out vec4 FragColor;
 in vec3 ourColor;
 in vec2 interpTexCoord;
 
+uniform float mixStrength;
+
+#ifdef TEXTURE_ARRAY
+// Both materials live in one array texture (see MaterialAtlas). A rect maps the material's uv into its part of the layer.
+uniform sampler2DArray texArray;
+uniform vec4 texRect;
+uniform vec4 tex2Rect;
+uniform vec4 texLayers; // x for tex, y for tex2. z and w are 1 when tex / tex2 repeat and 0 when they clamp to the edge.
+
+// The sampler's wrap mode covers the whole layer, not one entry, so the material's own wrap happens here. fract() keeps repeating uvs inside
+// their entry. Clamping stops half a texel short of the edge, where GL_CLAMP_TO_EDGE would, so nothing past the entry is blended in.
+// The gradients come from the unwrapped uv, so the wrap doesn't make the mip level jump.
+vec4 sampleMaterial(vec2 uv, vec4 rect, float layer, float repeat)
+{
+	vec2 gradX = dFdx(uv) * rect.zw;
+	vec2 gradY = dFdy(uv) * rect.zw;
+	vec2 halfTexel = 0.5 / (vec2(textureSize(texArray, 0).xy) * rect.zw);
+	vec2 wrapped = repeat > 0.5 ? fract(uv) : clamp(uv, halfTexel, 1.0 - halfTexel);
+	return textureGrad(texArray, vec3(wrapped * rect.zw + rect.xy, layer), gradX, gradY);
+}
+#else
 uniform sampler2D tex;
 uniform sampler2D tex2;
-uniform float mixStrength;
+#endif
 
 void main()
 {
 	vec2 mirrored = vec2(-interpTexCoord.x, interpTexCoord.y);
+#ifdef TEXTURE_ARRAY
+	FragColor = mix(sampleMaterial(interpTexCoord, texRect, texLayers.x, texLayers.z), sampleMaterial(mirrored, tex2Rect, texLayers.y, texLayers.w), mixStrength);
+#else
 	FragColor = mix(texture(tex, interpTexCoord), texture(tex2, mirrored), mixStrength); // mix linerarly interpolates between the two arguments based on the third. In this case, 80% of the color is taken from first texture.
+#endif
 };
\ No newline at end of file
@@ -8,13 +8,23 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 layout (location = 2) in vec2 texCoord;
+#ifdef INSTANCED
+layout (location = 3) in mat4 model; // One matrix per instance instead of a uniform. A mat4 uses locations 3 through 6.
+#endif
 
 out vec3 ourColor;
 out vec2 interpTexCoord;
 
+#ifndef INSTANCED
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 proj;
+#endif
+
+// Shared by every program. The buffer behind it is filled once per frame by CameraBlock.
+layout (std140) uniform Camera
+{
+   mat4 view;
+   mat4 proj;
+};
 
 void main()
 {
@@ -0,0 +1,323 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+
+AABB unionOf(const AABB& a, const AABB& b)
+{
+	AABB result;
+	result.min = glm::min(a.min, b.min);
+	result.max = glm::max(a.max, b.max);
+	return result;
+}
+
+AABB transformedBox(const glm::mat4& model, const glm::vec3& halfExtents)
+{
+	// Each world axis extent is the sum of the box axes projected onto it, which is |rotation * scale| times the half extents.
+	glm::vec3 center = glm::vec3(model[3]);
+	glm::vec3 extent = glm::abs(glm::vec3(model[0])) * halfExtents.x + glm::abs(glm::vec3(model[1])) * halfExtents.y + glm::abs(glm::vec3(model[2])) * halfExtents.z;
+	AABB result;
+	result.min = center - extent;
+	result.max = center + extent;
+	return result;
+}
+
+void BVH::build(const std::vector<AABB>& objectBounds)
+{
+	bounds = objectBounds;
+	const uint32_t count = (uint32_t)bounds.size();
+	objectOrder.resize(count);
+	centroids.resize(count);
+	leafOf.assign(count, 0);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		objectOrder[i] = i;
+		centroids[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+	}
+
+	nodes.clear();
+	dirtyNodes.clear();
+	if (count == 0) return;
+	nodes.reserve(2 * (count / maxLeafSize + 1));
+	nodes.push_back(Node());
+	buildNode(0, 0, 0, count);
+	centroids.clear();
+}
+
+// Fills in a node that's already in the array. Children are always appended after their parent, so walking the node array
+// backwards visits every child before its parent.
+void BVH::buildNode(uint32_t index, uint32_t parent, uint32_t begin, uint32_t end)
+{
+	nodes[index].parent = parent;
+
+	AABB nodeBounds = bounds[objectOrder[begin]];
+	AABB centroidBounds;
+	centroidBounds.min = centroids[objectOrder[begin]];
+	centroidBounds.max = centroidBounds.min;
+	for (uint32_t i = begin + 1; i < end; i++)
+	{
+		nodeBounds = unionOf(nodeBounds, bounds[objectOrder[i]]);
+		centroidBounds.min = glm::min(centroidBounds.min, centroids[objectOrder[i]]);
+		centroidBounds.max = glm::max(centroidBounds.max, centroids[objectOrder[i]]);
+	}
+	nodes[index].bounds = nodeBounds;
+
+	if (end - begin <= maxLeafSize)
+	{
+		nodes[index].first = begin;
+		nodes[index].count = end - begin;
+		for (uint32_t i = begin; i < end; i++)
+		{
+			leafOf[objectOrder[i]] = index;
+		}
+		return;
+	}
+
+	// Split at the median centroid along the axis the centroids are most spread on. Always balanced, so the depth stays at log2(n / leaf size).
+	glm::vec3 spread = centroidBounds.max - centroidBounds.min;
+	int axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+	uint32_t middle = begin + (end - begin) / 2;
+	const std::vector<glm::vec3>& c = centroids;
+	std::nth_element(objectOrder.begin() + begin, objectOrder.begin() + middle, objectOrder.begin() + end, [&c, axis](uint32_t a, uint32_t b)
+	{
+		return c[a][axis] < c[b][axis];
+	});
+
+	// The two children sit next to each other, so only the first one's index has to be stored.
+	const uint32_t left = (uint32_t)nodes.size();
+	nodes[index].first = left;
+	nodes[index].count = 0;
+	nodes.push_back(Node());
+	nodes.push_back(Node());
+	buildNode(left, index, begin, middle);
+	buildNode(left + 1, index, middle, end);
+}
+
+void BVH::update(uint32_t object, const AABB& objectBounds)
+{
+	bounds[object] = objectBounds;
+	// Stop at the first node that's already dirty, everything above it is marked too.
+	uint32_t node = leafOf[object];
+	while (!nodes[node].dirty)
+	{
+		nodes[node].dirty = true;
+		dirtyNodes.push_back(node);
+		if (node == 0) break;
+		node = nodes[node].parent;
+	}
+}
+
+void BVH::refit()
+{
+	if (dirtyNodes.empty()) return;
+
+	// Highest index first is children before parents. When a good part of the tree is dirty, a backwards sweep over all nodes
+	// is cheaper than sorting the dirty list.
+	if (dirtyNodes.size() * 16 > nodes.size())
+	{
+		for (size_t i = nodes.size(); i-- > 0;)
+		{
+			if (nodes[i].dirty) refitNode((uint32_t)i);
+		}
+	}
+	else
+	{
+		std::sort(dirtyNodes.begin(), dirtyNodes.end(), [](uint32_t a, uint32_t b)
+		{
+			return a > b;
+		});
+		for (uint32_t index : dirtyNodes)
+		{
+			refitNode(index);
+		}
+	}
+	dirtyNodes.clear();
+}
+
+void BVH::refitNode(uint32_t index)
+{
+	Node& node = nodes[index];
+	if (node.count > 0)
+	{
+		AABB nodeBounds = bounds[objectOrder[node.first]];
+		for (uint32_t i = node.first + 1; i < node.first + node.count; i++)
+		{
+			nodeBounds = unionOf(nodeBounds, bounds[objectOrder[i]]);
+		}
+		node.bounds = nodeBounds;
+	}
+	else
+	{
+		node.bounds = unionOf(nodes[node.first].bounds, nodes[node.first + 1].bounds);
+	}
+	node.dirty = false;
+}
+
+void BVH::collect(uint32_t node, std::vector<uint32_t>& out) const
+{
+	// A subtree's objects are one contiguous run of objectOrder, from its leftmost leaf to its rightmost one.
+	uint32_t leftmost = node;
+	while (nodes[leftmost].count == 0)
+	{
+		leftmost = nodes[leftmost].first;
+	}
+	uint32_t rightmost = node;
+	while (nodes[rightmost].count == 0)
+	{
+		rightmost = nodes[rightmost].first + 1;
+	}
+	out.insert(out.end(), objectOrder.begin() + nodes[leftmost].first, objectOrder.begin() + nodes[rightmost].first + nodes[rightmost].count);
+}
+
+namespace
+{
+	enum class Containment { Outside, Intersecting, Inside };
+
+	// For each plane, the corner furthest along the normal decides if the box is outside, the nearest corner if it's fully inside.
+	Containment classify(const Frustum& frustum, const AABB& box)
+	{
+		Containment result = Containment::Inside;
+		for (const glm::vec4& plane : frustum.planes)
+		{
+			glm::vec3 normal(plane);
+			glm::vec3 furthest(normal.x >= 0.f ? box.max.x : box.min.x, normal.y >= 0.f ? box.max.y : box.min.y, normal.z >= 0.f ? box.max.z : box.min.z);
+			if (glm::dot(normal, furthest) + plane.w < 0.f) return Containment::Outside;
+			glm::vec3 nearest(normal.x >= 0.f ? box.min.x : box.max.x, normal.y >= 0.f ? box.min.y : box.max.y, normal.z >= 0.f ? box.min.z : box.max.z);
+			if (glm::dot(normal, nearest) + plane.w < 0.f) result = Containment::Intersecting;
+		}
+		return result;
+	}
+}
+
+void BVH::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const
+{
+	if (nodes.empty()) return;
+
+	uint32_t stack[64];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	{
+		const uint32_t index = stack[--top];
+		const Node& node = nodes[index];
+		Containment containment = classify(frustum, node.bounds);
+		if (containment == Containment::Outside) continue;
+
+		if (containment == Containment::Inside)
+		{
+			collect(index, out);
+		}
+		else if (node.count == 0)
+		{
+			stack[top++] = node.first;
+			stack[top++] = node.first + 1;
+		}
+		else
+		{
+			for (uint32_t i = node.first; i < node.first + node.count; i++)
+			{
+				if (classify(frustum, bounds[objectOrder[i]]) != Containment::Outside) out.push_back(objectOrder[i]);
+			}
+		}
+	}
+}
+
+void BVH::queryRadius(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const
+{
+	if (nodes.empty()) return;
+
+	const float radiusSquared = radius * radius;
+	uint32_t stack[64];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	{
+		const Node& node = nodes[stack[--top]];
+		glm::vec3 closest = glm::clamp(center, node.bounds.min, node.bounds.max);
+		glm::vec3 offset = closest - center;
+		if (glm::dot(offset, offset) > radiusSquared) continue;
+
+		if (node.count == 0)
+		{
+			stack[top++] = node.first;
+			stack[top++] = node.first + 1;
+			continue;
+		}
+		for (uint32_t i = node.first; i < node.first + node.count; i++)
+		{
+			const AABB& box = bounds[objectOrder[i]];
+			closest = glm::clamp(center, box.min, box.max);
+			offset = closest - center;
+			if (glm::dot(offset, offset) <= radiusSquared) out.push_back(objectOrder[i]);
+		}
+	}
+}
+
+namespace
+{
+	// Slab test. Returns the distance where the ray enters the box, or a negative number if it misses.
+	float rayEnter(const AABB& box, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance)
+	{
+		glm::vec3 t0 = (box.min - origin) * inverseDirection;
+		glm::vec3 t1 = (box.max - origin) * inverseDirection;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+		float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.f));
+		float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+		return enter <= exit ? enter : -1.f;
+	}
+}
+
+bool BVH::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, uint32_t& outObject, float& outDistance) const
+{
+	if (nodes.empty()) return false;
+
+	// Division by a zero component gives infinity, which the slab test handles on its own.
+	const glm::vec3 inverseDirection = 1.f / direction;
+	float best = maxDistance;
+	bool hit = false;
+	uint32_t stack[64];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	{
+		const Node& node = nodes[stack[--top]];
+		if (rayEnter(node.bounds, origin, inverseDirection, best) < 0.f) continue;
+
+		if (node.count == 0)
+		{
+			// Push the farther child first so the nearer one is searched first and shrinks best sooner.
+			float left = rayEnter(nodes[node.first].bounds, origin, inverseDirection, best);
+			float right = rayEnter(nodes[node.first + 1].bounds, origin, inverseDirection, best);
+			if (left >= 0.f && right >= 0.f)
+			{
+				stack[top++] = left < right ? node.first + 1 : node.first;
+				stack[top++] = left < right ? node.first : node.first + 1;
+			}
+			else if (left >= 0.f)
+			{
+				stack[top++] = node.first;
+			}
+			else if (right >= 0.f)
+			{
+				stack[top++] = node.first + 1;
+			}
+			continue;
+		}
+		for (uint32_t i = node.first; i < node.first + node.count; i++)
+		{
+			float distance = rayEnter(bounds[objectOrder[i]], origin, inverseDirection, best);
+			if (distance >= 0.f && (!hit || distance < best))
+			{
+				best = distance;
+				outObject = objectOrder[i];
+				hit = true;
+			}
+		}
+	}
+	if (hit) outDistance = best;
+	return hit;
+}
+
+size_t BVH::objectCount() const
+{
+	return bounds.size();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "FrustumCuller.h"
+
+struct AABB
+{
+	glm::vec3 min = glm::vec3(0.f);
+	glm::vec3 max = glm::vec3(0.f);
+};
+
+AABB unionOf(const AABB& a, const AABB& b);
+// Bounds of a box of the given half extents after it's been through model. Tight for any rotation, unlike transforming the corners of a loose box.
+AABB transformedBox(const glm::mat4& model, const glm::vec3& halfExtents);
+
+// A bounding volume hierarchy over object bounds, for visibility and proximity queries that don't have to look at every object.
+// Built top down with median splits on the longest axis. Moving objects don't rebuild it: update() marks their leaf and its
+// ancestors dirty, and refit() recomputes only those nodes, children before parents. Refitting keeps the tree correct but slowly
+// loosens it as objects drift from where they were at build time, so call build() again now and then if objects travel far.
+class BVH
+{
+public:
+	void build(const std::vector<AABB>& objectBounds);
+	void update(uint32_t object, const AABB& bounds);
+	void refit();
+
+	// Appends the objects whose bounds touch the frustum. Subtrees entirely inside skip the plane tests.
+	void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const;
+	// Appends the objects whose bounds come within radius of center.
+	void queryRadius(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const;
+	// The object whose bounds the ray enters first. Returns false if it hits nothing before maxDistance.
+	bool queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, uint32_t& outObject, float& outDistance) const;
+
+	size_t objectCount() const;
+
+private:
+	struct Node
+	{
+		AABB bounds;
+		uint32_t first = 0; // First child for an inner node (the second is first + 1), first entry of objectOrder for a leaf.
+		uint32_t count = 0; // Number of objects in a leaf, 0 for an inner node.
+		uint32_t parent = 0;
+		bool dirty = false;
+	};
+
+	static const uint32_t maxLeafSize = 4;
+
+	void buildNode(uint32_t index, uint32_t parent, uint32_t begin, uint32_t end);
+	void refitNode(uint32_t index);
+	void collect(uint32_t node, std::vector<uint32_t>& out) const;
+
+	std::vector<Node> nodes;
+	std::vector<AABB> bounds;
+	std::vector<uint32_t> objectOrder; // Object indices, grouped so each leaf's objects are contiguous.
+	std::vector<uint32_t> leafOf;
+	std::vector<uint32_t> dirtyNodes;
+	std::vector<glm::vec3> centroids; // Only used while building.
+};
@@ -0,0 +1,569 @@
+#include "TextureFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stb_image.h>
+#include "BlockCompression.h"
+#include "MipChain.h"
+#include "GLState.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(TextureFileLevel) == 24, "TextureFileLevel is read straight from disk, its layout can't change");
+static_assert(sizeof(TextureFileHeader) == 40 + 24 * textureFileMaxLevels, "TextureFileHeader is read straight from disk, its layout can't change");
+
+namespace
+{
+	const size_t levelAlignment = 16;
+
+	// Bytes per texel of a tightly packed upload in format/type, or 0 for pairs the files never use.
+	size_t bytesPerPixel(GLenum format, GLenum type)
+	{
+		size_t components = 0;
+		switch (format)
+		{
+		case GL_RED: components = 1; break;
+		case GL_RG: components = 2; break;
+		case GL_RGB:
+		case GL_BGR: components = 3; break;
+		case GL_RGBA:
+		case GL_BGRA: components = 4; break;
+		default: return 0;
+		}
+		switch (type)
+		{
+		case GL_UNSIGNED_BYTE: return components;
+		case GL_UNSIGNED_SHORT:
+		case GL_HALF_FLOAT: return components * 2;
+		case GL_FLOAT: return components * 4;
+		case GL_UNSIGNED_SHORT_5_6_5: return components == 3 ? 2 : 0;
+		case GL_UNSIGNED_SHORT_4_4_4_4:
+		case GL_UNSIGNED_SHORT_5_5_5_1: return components == 4 ? 2 : 0;
+		default: return 0;
+		}
+	}
+
+	// Checks every level is the size the mip chain of a width x height texture says it should be, fits in the file, and holds exactly
+	// the bytes GL will read for it: the blocks its size needs when compressed, width * height texels of format/type otherwise.
+	bool validLevels(const TextureFileLevel* levels, uint32_t levelCount, uint32_t width, uint32_t height, GLenum internalFormat, GLenum format, GLenum type,
+		bool compressed, size_t fileSize, const std::string& path)
+	{
+		if (width == 0 || height == 0)
+		{
+			std::cout << path << " is " << width << "x" << height << '\n';
+			return false;
+		}
+		const size_t texelBytes = compressed ? 0 : bytesPerPixel(format, type);
+		if (!compressed && texelBytes == 0)
+		{
+			std::cout << path << " uses pixel format 0x" << std::hex << format << " / type 0x" << type << std::dec << ", which we can't load\n";
+			return false;
+		}
+		for (uint32_t i = 0; i < levelCount; i++)
+		{
+			const TextureFileLevel& level = levels[i];
+			const uint32_t levelWidth = std::max(width >> i, 1u);
+			const uint32_t levelHeight = std::max(height >> i, 1u);
+			if (level.width != levelWidth || level.height != levelHeight)
+			{
+				std::cout << path << " mip level " << i << " is " << level.width << "x" << level.height << ", a " << width << "x" << height << " texture needs "
+					<< levelWidth << "x" << levelHeight << '\n';
+				return false;
+			}
+			if (level.offset > fileSize || level.size > fileSize - level.offset)
+			{
+				std::cout << path << " is truncated, mip level " << i << " runs past the end of the file\n";
+				return false;
+			}
+			const uint64_t expected = compressed ? compressedLevelSize(internalFormat, levelWidth, levelHeight) : (uint64_t)levelWidth * levelHeight * texelBytes;
+			if (level.size != expected)
+			{
+				std::cout << path << " mip level " << i << " is " << level.size << " bytes, a " << levelWidth << "x" << levelHeight << " level needs " << expected << '\n';
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool validHeader(const TextureFileHeader& header, size_t fileSize, const std::string& path)
+	{
+		if (memcmp(header.magic, textureFileMagic, sizeof(textureFileMagic)) != 0)
+		{
+			std::cout << path << " is not a texture file\n";
+			return false;
+		}
+		if (header.version != textureFileVersion)
+		{
+			std::cout << path << " is texture file version " << header.version << ", expected " << textureFileVersion << ". Bake it again with --bake-textures\n";
+			return false;
+		}
+		if (header.levelCount == 0 || header.levelCount > (uint32_t)textureFileMaxLevels)
+		{
+			std::cout << path << " has " << header.levelCount << " mip levels\n";
+			return false;
+		}
+		return validLevels(header.levels, header.levelCount, header.width, header.height, header.internalFormat, header.format, header.type, header.compressed != 0, fileSize, path);
+	}
+
+	// Makes a texture out of levels that point into base, which is usually a mapped file.
+	GLuint createTexture(const std::string& path, GLenum internalFormat, GLenum format, GLenum type, bool compressed, const TextureFileLevel* levels, uint32_t levelCount,
+		const unsigned char* base, int sWrap, int tWrap, int magFilter)
+	{
+		if (compressed && !compressedFormatSupported(internalFormat))
+		{
+			std::cout << path << " uses compressed format 0x" << std::hex << internalFormat << std::dec << ", which this context doesn't support\n";
+			return 0;
+		}
+
+		GLuint texture = 0;
+		glGenTextures(1, &texture);
+		glState.bindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sWrap);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, tWrap);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levelCount - 1);
+		// The pixels are read straight out of the mapping, so nothing can be bound to GL_PIXEL_UNPACK_BUFFER, or the pointer would be taken as an offset.
+		glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Levels are tightly packed.
+		for (uint32_t i = 0; i < levelCount; i++)
+		{
+			const TextureFileLevel& level = levels[i];
+			const unsigned char* pixels = base + level.offset;
+			if (compressed)
+			{
+				glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, level.width, level.height, 0, (GLsizei)level.size, pixels);
+			}
+			else
+			{
+				glTexImage2D(GL_TEXTURE_2D, (GLint)i, (GLint)internalFormat, level.width, level.height, 0, format, type, pixels);
+			}
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glState.bindTexture(GL_TEXTURE_2D, 0);
+		// glTexImage2D has copied everything it needs by the time it returns, so the mapping can go away after this.
+		return texture;
+	}
+
+	// Lays out levelCount levels of a block compressed format back to back from offset, the way both DDS and our own files store them.
+	uint32_t compressedChain(GLenum internalFormat, uint32_t width, uint32_t height, uint32_t levelCount, uint64_t offset, TextureFileLevel* levels)
+	{
+		levelCount = std::min(std::max(levelCount, 1u), (uint32_t)textureFileMaxLevels);
+		for (uint32_t i = 0; i < levelCount; i++)
+		{
+			levels[i].width = std::max(width >> i, 1u);
+			levels[i].height = std::max(height >> i, 1u);
+			levels[i].offset = offset;
+			levels[i].size = compressedLevelSize(internalFormat, levels[i].width, levels[i].height);
+			offset += levels[i].size;
+		}
+		return levelCount;
+	}
+
+	uint32_t readU32(const unsigned char* data)
+	{
+		return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+	}
+
+	uint64_t readU64(const unsigned char* data)
+	{
+		return (uint64_t)readU32(data) | ((uint64_t)readU32(data + 4) << 32);
+	}
+
+	GLenum formatFromFourCC(const unsigned char* fourCC)
+	{
+		if (memcmp(fourCC, "DXT1", 4) == 0) return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		if (memcmp(fourCC, "DXT3", 4) == 0) return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+		if (memcmp(fourCC, "DXT5", 4) == 0) return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		return GL_NONE;
+	}
+
+	GLenum formatFromDXGI(uint32_t dxgiFormat)
+	{
+		switch (dxgiFormat)
+		{
+		case 71: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; // DXGI_FORMAT_BC1_UNORM
+		case 72: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; // DXGI_FORMAT_BC1_UNORM_SRGB
+		case 74: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; // DXGI_FORMAT_BC2_UNORM
+		case 75: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+		case 77: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; // DXGI_FORMAT_BC3_UNORM
+		case 78: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM; // DXGI_FORMAT_BC7_UNORM
+		case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+		default: return GL_NONE;
+		}
+	}
+
+	GLenum formatFromVulkan(uint32_t vkFormat)
+	{
+		switch (vkFormat)
+		{
+		case 131: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT; // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+		case 132: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+		case 133: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+		case 134: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+		case 135: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; // VK_FORMAT_BC2_UNORM_BLOCK
+		case 136: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+		case 137: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; // VK_FORMAT_BC3_UNORM_BLOCK
+		case 138: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM; // VK_FORMAT_BC7_UNORM_BLOCK
+		case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+		case 147: return GL_COMPRESSED_RGB8_ETC2; // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+		case 148: return GL_COMPRESSED_SRGB8_ETC2;
+		case 151: return GL_COMPRESSED_RGBA8_ETC2_EAC; // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+		case 152: return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+		default: return GL_NONE;
+		}
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "Could not open " << path << '\n';
+		return false;
+	}
+	file = handle;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		std::cout << "Could not map " << path << ", it is empty\n";
+		close();
+		return false;
+	}
+	mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping != nullptr)
+	{
+		view = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	length = (size_t)fileSize.QuadPart;
+#else
+	file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		std::cout << "Could not open " << path << '\n';
+		return false;
+	}
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0)
+	{
+		std::cout << "Could not map " << path << ", it is empty\n";
+		close();
+		return false;
+	}
+	length = (size_t)info.st_size;
+	void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+	if (mapped != MAP_FAILED)
+	{
+		view = (const unsigned char*)mapped;
+		// The driver reads every level front to back, so tell the kernel to read ahead.
+		madvise(mapped, length, MADV_SEQUENTIAL);
+	}
+#endif
+	if (view == nullptr)
+	{
+		std::cout << "Could not map " << path << '\n';
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (view != nullptr) UnmapViewOfFile(view);
+	if (mapping != nullptr) CloseHandle(mapping);
+	if (file != nullptr) CloseHandle(file);
+	mapping = nullptr;
+	file = nullptr;
+#else
+	if (view != nullptr) munmap((void*)view, length);
+	if (file >= 0) ::close(file);
+	file = -1;
+#endif
+	view = nullptr;
+	length = 0;
+}
+
+const unsigned char* MappedFile::data() const
+{
+	return view;
+}
+
+size_t MappedFile::size() const
+{
+	return length;
+}
+
+bool writeTextureFile(const std::string& path, const TextureFileData& texture)
+{
+	if (texture.levels.empty() || texture.levels.size() > (size_t)textureFileMaxLevels)
+	{
+		std::cout << "Can't write " << path << " with " << texture.levels.size() << " mip levels\n";
+		return false;
+	}
+
+	TextureFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, textureFileMagic, sizeof(textureFileMagic));
+	header.version = textureFileVersion;
+	header.width = texture.width;
+	header.height = texture.height;
+	header.levelCount = (uint32_t)texture.levels.size();
+	header.internalFormat = texture.internalFormat;
+	header.format = texture.format;
+	header.type = texture.type;
+	header.compressed = texture.compressed ? 1 : 0;
+
+	uint64_t offset = sizeof(TextureFileHeader);
+	for (size_t i = 0; i < texture.levels.size(); i++)
+	{
+		offset = (offset + levelAlignment - 1) / levelAlignment * levelAlignment;
+		header.levels[i].width = std::max(texture.width >> i, 1u);
+		header.levels[i].height = std::max(texture.height >> i, 1u);
+		header.levels[i].offset = offset;
+		header.levels[i].size = texture.levels[i].size();
+		offset += texture.levels[i].size();
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "Could not write " << path << '\n';
+		return false;
+	}
+	file.write((const char*)&header, sizeof(header));
+	const char zeros[levelAlignment] = {};
+	uint64_t written = sizeof(header);
+	for (size_t i = 0; i < texture.levels.size(); i++)
+	{
+		file.write(zeros, (std::streamsize)(header.levels[i].offset - written));
+		file.write((const char*)texture.levels[i].data(), (std::streamsize)texture.levels[i].size());
+		written = header.levels[i].offset + header.levels[i].size;
+	}
+	if (!file)
+	{
+		std::cout << "Could not write " << path << '\n';
+		return false;
+	}
+	return true;
+}
+
+bool convertTexture(const std::string& sourcePath, const std::string& destPath, bool compress)
+{
+	// Same orientation the runtime loader has always produced, so baked and unbaked textures look the same.
+	stbi_set_flip_vertically_on_load_thread(true);
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	unsigned char* data = stbi_load(sourcePath.c_str(), &width, &height, &channels, 0);
+	if (data == nullptr)
+	{
+		std::cout << "Failed to load texture from " << sourcePath << '\n';
+		return false;
+	}
+
+	TextureFileData texture;
+	texture.width = (uint32_t)width;
+	texture.height = (uint32_t)height;
+	switch (channels)
+	{
+	case 1: texture.internalFormat = GL_R8; texture.format = GL_RED; break;
+	case 2: texture.internalFormat = GL_RG8; texture.format = GL_RG; break;
+	case 3: texture.internalFormat = GL_RGB8; texture.format = GL_RGB; break;
+	default: texture.internalFormat = GL_RGBA8; texture.format = GL_RGBA; break;
+	}
+	texture.type = GL_UNSIGNED_BYTE;
+
+	// The same box filtered chain the loader builds at runtime by default, so a baked texture looks the same as the image it came from.
+	buildMipChain(nullptr, data, texture.width, texture.height, channels, MipOptions(), texture.levels);
+	stbi_image_free(data);
+	if (texture.levels.size() > (size_t)textureFileMaxLevels)
+	{
+		texture.levels.resize(textureFileMaxLevels);
+	}
+
+	size_t uncompressedBytes = 0;
+	for (const std::vector<unsigned char>& level : texture.levels)
+	{
+		uncompressedBytes += level.size();
+	}
+	size_t bytes = uncompressedBytes;
+	// The mips are made from the uncompressed levels and each is encoded on its own, so block errors never feed into the next level down.
+	if (compress && channels >= 3)
+	{
+		texture.internalFormat = channels == 3 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		texture.format = GL_NONE;
+		texture.type = GL_NONE;
+		texture.compressed = true;
+		bytes = 0;
+		for (size_t i = 0; i < texture.levels.size(); i++)
+		{
+			std::vector<unsigned char> blocks;
+			const uint32_t width = std::max(texture.width >> i, 1u);
+			const uint32_t height = std::max(texture.height >> i, 1u);
+			if (channels == 3)
+			{
+				encodeBC1(texture.levels[i].data(), width, height, channels, blocks);
+			}
+			else
+			{
+				encodeBC3(texture.levels[i].data(), width, height, channels, blocks);
+			}
+			bytes += blocks.size();
+			texture.levels[i] = std::move(blocks);
+		}
+	}
+	std::cout << sourcePath << ": " << texture.width << "x" << texture.height << ", " << texture.levels.size() << " levels, "
+		<< (bytes + 1023) / 1024 << " KB" << (texture.compressed ? " compressed from " + std::to_string((uncompressedBytes + 1023) / 1024) + " KB" : "") << '\n';
+
+	return writeTextureFile(destPath, texture);
+}
+
+std::string bakedTexturePath(const std::string& sourcePath)
+{
+	const size_t dot = sourcePath.find_last_of('.');
+	const size_t slash = sourcePath.find_last_of("/\\");
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+	{
+		return sourcePath + textureFileExtension;
+	}
+	return sourcePath.substr(0, dot) + textureFileExtension;
+}
+
+GLuint loadTextureFile(const std::string& path, int sWrap, int tWrap, int magFilter)
+{
+	MappedFile file;
+	if (!file.open(path)) return 0;
+	if (file.size() < sizeof(TextureFileHeader))
+	{
+		std::cout << path << " is too small to be a texture file\n";
+		return 0;
+	}
+	const TextureFileHeader& header = *(const TextureFileHeader*)file.data();
+	if (!validHeader(header, file.size(), path)) return 0;
+	return createTexture(path, header.internalFormat, header.format, header.type, header.compressed != 0, header.levels, header.levelCount, file.data(), sWrap, tWrap, magFilter);
+}
+
+GLuint loadDDSFile(const std::string& path, int sWrap, int tWrap, int magFilter)
+{
+	// "DDS " then a 124 byte DDS_HEADER, then a 20 byte DDS_HEADER_DXT10 if the pixel format's fourCC is "DX10".
+	const size_t headerSize = 128;
+	const size_t dx10HeaderSize = 20;
+	MappedFile file;
+	if (!file.open(path)) return 0;
+	const unsigned char* data = file.data();
+	if (file.size() < headerSize || memcmp(data, "DDS ", 4) != 0)
+	{
+		std::cout << path << " is not a DDS file\n";
+		return 0;
+	}
+	const uint32_t height = readU32(data + 12);
+	const uint32_t width = readU32(data + 16);
+	const uint32_t mipCount = readU32(data + 28);
+	const unsigned char* fourCC = data + 84;
+	GLenum internalFormat = GL_NONE;
+	uint64_t offset = headerSize;
+	if (memcmp(fourCC, "DX10", 4) == 0)
+	{
+		if (file.size() < headerSize + dx10HeaderSize)
+		{
+			std::cout << path << " is truncated\n";
+			return 0;
+		}
+		const uint32_t dimension = readU32(data + headerSize + 4);
+		const uint32_t arraySize = readU32(data + headerSize + 12);
+		if (dimension != 3 || arraySize > 1) // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+		{
+			std::cout << path << " is not a single 2D texture\n";
+			return 0;
+		}
+		internalFormat = formatFromDXGI(readU32(data + headerSize));
+		offset += dx10HeaderSize;
+	}
+	else
+	{
+		internalFormat = formatFromFourCC(fourCC);
+	}
+	if (internalFormat == GL_NONE)
+	{
+		std::cout << path << " is not in a block compressed format we can load\n";
+		return 0;
+	}
+
+	TextureFileLevel levels[textureFileMaxLevels];
+	const uint32_t levelCount = compressedChain(internalFormat, width, height, mipCount, offset, levels);
+	if (!validLevels(levels, levelCount, width, height, internalFormat, GL_NONE, GL_NONE, true, file.size(), path)) return 0;
+	return createTexture(path, internalFormat, GL_NONE, GL_NONE, true, levels, levelCount, data, sWrap, tWrap, magFilter);
+}
+
+GLuint loadKTX2File(const std::string& path, int sWrap, int tWrap, int magFilter)
+{
+	// 12 byte identifier, nine uint32 fields, the data format / key value / supercompression global data index, then one
+	// (offset, length, uncompressed length) triple of uint64 per level.
+	const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+	const size_t levelIndexOffset = 80;
+	const size_t levelIndexEntrySize = 24;
+	MappedFile file;
+	if (!file.open(path)) return 0;
+	const unsigned char* data = file.data();
+	if (file.size() < levelIndexOffset || memcmp(data, identifier, sizeof(identifier)) != 0)
+	{
+		std::cout << path << " is not a KTX2 file\n";
+		return 0;
+	}
+	const GLenum internalFormat = formatFromVulkan(readU32(data + 12));
+	const uint32_t width = readU32(data + 20);
+	const uint32_t height = readU32(data + 24);
+	const uint32_t depth = readU32(data + 28);
+	const uint32_t layerCount = readU32(data + 32);
+	const uint32_t faceCount = readU32(data + 36);
+	const uint32_t levelCount = std::max(readU32(data + 40), 1u); // 0 asks the loader to make mips. We just load the one level.
+	const uint32_t supercompression = readU32(data + 44);
+	if (internalFormat == GL_NONE)
+	{
+		std::cout << path << " is not in a block compressed format we can load\n";
+		return 0;
+	}
+	if (depth > 1 || layerCount > 1 || faceCount != 1 || supercompression != 0 || levelCount > (uint32_t)textureFileMaxLevels)
+	{
+		std::cout << path << " is not a single, non-supercompressed 2D texture\n";
+		return 0;
+	}
+	if (file.size() < levelIndexOffset + levelCount * levelIndexEntrySize)
+	{
+		std::cout << path << " is truncated\n";
+		return 0;
+	}
+
+	TextureFileLevel levels[textureFileMaxLevels];
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		const unsigned char* entry = data + levelIndexOffset + i * levelIndexEntrySize;
+		levels[i].width = std::max(width >> i, 1u);
+		levels[i].height = std::max(height >> i, 1u);
+		levels[i].offset = readU64(entry);
+		levels[i].size = readU64(entry + 8);
+	}
+	if (!validLevels(levels, levelCount, width, height, internalFormat, GL_NONE, GL_NONE, true, file.size(), path)) return 0;
+	return createTexture(path, internalFormat, GL_NONE, GL_NONE, true, levels, levelCount, data, sWrap, tWrap, magFilter);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+// A texture that has already been through everything loading it from an image would do at startup: decoded, flipped, mipmapped and laid out in the
+// format GL will store it in. The file is a fixed size header followed by every level, tightly packed (no row padding) and 16 byte aligned.
+// Loading maps the file and hands each level's bytes straight to GL, so there is nothing to decode and nothing to copy on our side.
+// Integers are stored little endian, which is what every platform we build for uses, so the header is read in place.
+const char textureFileMagic[4] = { 'L', 'T', 'E', 'X' };
+const uint32_t textureFileVersion = 1;
+const int textureFileMaxLevels = 16;
+const char* const textureFileExtension = ".ltex";
+
+struct TextureFileLevel
+{
+	uint32_t width;
+	uint32_t height;
+	uint64_t offset; // From the start of the file.
+	uint64_t size;
+};
+
+struct TextureFileHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t levelCount;
+	uint32_t internalFormat;
+	// Only meaningful for uncompressed levels. Compressed levels go through glCompressedTexImage2D, which only needs the internal format.
+	uint32_t format;
+	uint32_t type;
+	uint32_t compressed;
+	uint32_t reserved; // Keeps the levels 8 byte aligned without the compiler adding padding of its own.
+	TextureFileLevel levels[textureFileMaxLevels];
+};
+
+// A read-only view of a whole file. The pages are only read in when something touches them, which here is the driver during glTexImage2D.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+	const unsigned char* data() const;
+	size_t size() const;
+
+private:
+	const unsigned char* view = nullptr;
+	size_t length = 0;
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#else
+	int file = -1;
+#endif
+};
+
+// One texture in memory, ready to be written out. levels[i] holds the bytes of mip level i.
+struct TextureFileData
+{
+	uint32_t width = 0;
+	uint32_t height = 0;
+	GLenum internalFormat = GL_RGBA8;
+	GLenum format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+	bool compressed = false;
+	std::vector<std::vector<unsigned char>> levels;
+};
+
+bool writeTextureFile(const std::string& path, const TextureFileData& texture);
+// Decodes an image with stb_image, flips it the way the loader always has, builds the full mip chain on the CPU (buildMipChain) and writes it out.
+// This is the build step, run with --bake-textures. The internal format follows the channel count of the source.
+// With compress, RGB images are encoded as BC1 and RGBA images as BC3 (see BlockCompression.h). One and two channel images stay uncompressed.
+bool convertTexture(const std::string& sourcePath, const std::string& destPath, bool compress = false);
+// Swaps the extension for textureFileExtension. "./Resources/container.jpg" becomes "./Resources/container.ltex".
+std::string bakedTexturePath(const std::string& sourcePath);
+// Creates a complete, mipmapped GL_TEXTURE_2D from a baked file. Returns 0 and prints why if the file is missing or malformed.
+GLuint loadTextureFile(const std::string& path, int sWrap = GL_REPEAT, int tWrap = GL_REPEAT, int magFilter = GL_LINEAR);
+// The same for block compressed textures made by other tools, as DDS (including the DX10 header) or uncompressed-supercompression KTX2.
+// Only single 2D images in the block formats BlockCompression.h knows are accepted. Both formats store the top row first while GL's
+// first row is the bottom one, and compressed blocks can't be flipped on load, so these files have to be exported flipped for our UVs.
+GLuint loadDDSFile(const std::string& path, int sWrap = GL_REPEAT, int tWrap = GL_REPEAT, int magFilter = GL_LINEAR);
+GLuint loadKTX2File(const std::string& path, int sWrap = GL_REPEAT, int tWrap = GL_REPEAT, int magFilter = GL_LINEAR);
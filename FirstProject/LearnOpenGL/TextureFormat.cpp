@@ -0,0 +1,219 @@
+#include "TextureFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "BlockCompression.h"
+#include "GLExtensions.h"
+
+namespace
+{
+	// Rounds an 8 bit value to bits bits and back, the way the GPU will expand it again when sampling.
+	inline unsigned int quantize(unsigned int value, unsigned int bits)
+	{
+		const unsigned int maxValue = (1u << bits) - 1;
+		return (value * maxValue + 127) / 255;
+	}
+
+	inline unsigned int expand(unsigned int value, unsigned int bits)
+	{
+		const unsigned int maxValue = (1u << bits) - 1;
+		return (value * 255 + maxValue / 2) / maxValue;
+	}
+
+	double psnrFromError(double squaredError, size_t samples)
+	{
+		if (squaredError == 0.0 || samples == 0) return std::numeric_limits<double>::infinity();
+		return 10.0 * std::log10(255.0 * 255.0 * samples / squaredError);
+	}
+
+	// Packs RGB(A) texels into 16 bit texels with the given bit counts per channel, first channel in the high bits, as
+	// GL_UNSIGNED_SHORT_5_6_5, GL_UNSIGNED_SHORT_4_4_4_4 and GL_UNSIGNED_SHORT_5_5_5_1 expect. Returns the PSNR of the result.
+	double pack16(const unsigned char* pixels, size_t texels, int channels, const unsigned int* bits, std::vector<unsigned char>& out)
+	{
+		const int packedChannels = bits[3] == 0 ? 3 : 4;
+		out.resize(texels * 2);
+		uint16_t* dst = (uint16_t*)out.data();
+		double error = 0.0;
+		for (size_t i = 0; i < texels; i++)
+		{
+			const unsigned char* texel = pixels + i * channels;
+			uint16_t packed = 0;
+			for (int c = 0; c < packedChannels; c++)
+			{
+				const unsigned int value = c < channels ? texel[c] : 255;
+				const unsigned int q = quantize(value, bits[c]);
+				packed = (uint16_t)((packed << bits[c]) | q);
+				if (c < channels)
+				{
+					const double diff = (double)value - expand(q, bits[c]);
+					error += diff * diff;
+				}
+			}
+			dst[i] = packed;
+		}
+		return psnrFromError(error, texels * std::min(channels, packedChannels));
+	}
+}
+
+TextureStorage chooseStorage(const unsigned char* pixels, int width, int height, int channels, const TexturePolicy& policy)
+{
+	TextureStorage storage;
+	const size_t texels = (size_t)width * height;
+
+	if (policy.mask || channels == 1)
+	{
+		storage.internalFormat = GL_R8;
+		storage.format = GL_RED;
+		storage.pixels.resize(texels);
+		for (size_t i = 0; i < texels; i++)
+		{
+			storage.pixels[i] = pixels[i * channels];
+		}
+		// Dropping the other channels is the point of a mask, so there is no meaningful error to report for it.
+		storage.psnr = channels == 1 ? std::numeric_limits<double>::infinity() : -1.0;
+		return storage;
+	}
+
+	storage.pixels.assign(pixels, pixels + texels * channels);
+	storage.psnr = std::numeric_limits<double>::infinity();
+	switch (channels)
+	{
+	case 2: storage.internalFormat = GL_RG8; storage.format = GL_RG; break;
+	case 3: storage.internalFormat = policy.srgb ? GL_SRGB8 : GL_RGB8; storage.format = GL_RGB; break;
+	default: storage.internalFormat = policy.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8; storage.format = GL_RGBA; break;
+	}
+	if (policy.srgb || policy.minPSNR <= 0.f || channels == 2) return storage;
+
+	std::vector<unsigned char> packed;
+	if (channels == 3)
+	{
+		const unsigned int bits565[4] = { 5, 6, 5, 0 };
+		const double psnr = pack16(pixels, texels, channels, bits565, packed);
+		if (psnr >= policy.minPSNR)
+		{
+			// GL_RGB565 only became a valid internal format in 4.1. Before that GL_RGB5 is the closest ask, and drivers store it as 565 anyway.
+			storage.internalFormat = glExt.rgb565 ? GL_RGB565 : GL_RGB5;
+			storage.type = GL_UNSIGNED_SHORT_5_6_5;
+			storage.pixels.swap(packed);
+			storage.psnr = psnr;
+		}
+		return storage;
+	}
+
+	// Both are two bytes a texel. 5551 keeps more colour but only on/off alpha, so it wins on cutouts and loses on soft edges.
+	const unsigned int bits5551[4] = { 5, 5, 5, 1 };
+	const unsigned int bits4444[4] = { 4, 4, 4, 4 };
+	std::vector<unsigned char> packed4444;
+	const double psnr5551 = pack16(pixels, texels, channels, bits5551, packed);
+	const double psnr4444 = pack16(pixels, texels, channels, bits4444, packed4444);
+	const bool use5551 = psnr5551 >= psnr4444;
+	const double psnr = use5551 ? psnr5551 : psnr4444;
+	if (psnr >= policy.minPSNR)
+	{
+		storage.internalFormat = use5551 ? GL_RGB5_A1 : GL_RGBA4;
+		storage.type = use5551 ? GL_UNSIGNED_SHORT_5_5_5_1 : GL_UNSIGNED_SHORT_4_4_4_4;
+		storage.pixels.swap(use5551 ? packed : packed4444);
+		storage.psnr = psnr;
+	}
+	return storage;
+}
+
+void convertToFormat(const unsigned char* pixels, size_t texels, int channels, GLenum internalFormat, std::vector<unsigned char>& out)
+{
+	const unsigned int bits565[4] = { 5, 6, 5, 0 };
+	const unsigned int bits5551[4] = { 5, 5, 5, 1 };
+	const unsigned int bits4444[4] = { 4, 4, 4, 4 };
+	switch (internalFormat)
+	{
+	case GL_R8:
+		out.resize(texels);
+		for (size_t i = 0; i < texels; i++)
+		{
+			out[i] = pixels[i * channels];
+		}
+		break;
+	case GL_RGB565:
+	case GL_RGB5: pack16(pixels, texels, channels, bits565, out); break;
+	case GL_RGB5_A1: pack16(pixels, texels, channels, bits5551, out); break;
+	case GL_RGBA4: pack16(pixels, texels, channels, bits4444, out); break;
+	default: out.assign(pixels, pixels + texels * channels); break;
+	}
+}
+
+size_t textureLevelBytes(GLenum internalFormat, uint32_t width, uint32_t height)
+{
+	if (compressedBlockBytes(internalFormat) != 0)
+	{
+		return compressedLevelSize(internalFormat, width, height);
+	}
+	size_t bytesPerTexel = 0;
+	switch (internalFormat)
+	{
+	case GL_R8: bytesPerTexel = 1; break;
+	case GL_RG8:
+	case GL_RGB565:
+	case GL_RGB5:
+	case GL_RGBA4:
+	case GL_RGB5_A1: bytesPerTexel = 2; break;
+	case GL_RGB8:
+	case GL_SRGB8:
+	case GL_RGBA8:
+	case GL_SRGB8_ALPHA8: bytesPerTexel = 4; break;
+	default: bytesPerTexel = 0; break;
+	}
+	return (size_t)width * height * bytesPerTexel;
+}
+
+size_t textureBytes(GLenum internalFormat, uint32_t width, uint32_t height, uint32_t levelCount)
+{
+	size_t bytes = 0;
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		bytes += textureLevelBytes(internalFormat, std::max(width >> i, 1u), std::max(height >> i, 1u));
+	}
+	return bytes;
+}
+
+uint32_t fullMipCount(uint32_t width, uint32_t height)
+{
+	uint32_t levels = 1;
+	uint32_t size = std::max(width, height);
+	while (size > 1)
+	{
+		size >>= 1;
+		levels++;
+	}
+	return levels;
+}
+
+const char* textureFormatName(GLenum internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_R8: return "R8";
+	case GL_RG8: return "RG8";
+	case GL_RGB8: return "RGB8";
+	case GL_RGBA8: return "RGBA8";
+	case GL_SRGB8: return "SRGB8";
+	case GL_SRGB8_ALPHA8: return "SRGB8_ALPHA8";
+	case GL_RGB565: return "RGB565";
+	case GL_RGB5: return "RGB5";
+	case GL_RGBA4: return "RGBA4";
+	case GL_RGB5_A1: return "RGB5_A1";
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return "BC1";
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT: return "BC1 sRGB";
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: return "BC2";
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT: return "BC2 sRGB";
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT: return "BC3 sRGB";
+	case GL_COMPRESSED_RGBA_BPTC_UNORM: return "BC7";
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM: return "BC7 sRGB";
+	case GL_COMPRESSED_RGB8_ETC2: return "ETC2 RGB";
+	case GL_COMPRESSED_SRGB8_ETC2: return "ETC2 sRGB";
+	case GL_COMPRESSED_RGBA8_ETC2_EAC: return "ETC2 RGBA";
+	case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC: return "ETC2 sRGB alpha";
+	default: return "unknown";
+	}
+}
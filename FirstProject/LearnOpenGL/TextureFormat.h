@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "MipChain.h"
+
+// How a texture may be stored on the GPU. The defaults keep full 8 bit precision in as many channels as the image has.
+struct TexturePolicy
+{
+	// Keep only the first channel as GL_R8. For masks and other single channel data stored in a regular image.
+	bool mask = false;
+	// Colour data authored in sRGB, stored as GL_SRGB8 / GL_SRGB8_ALPHA8 so sampling returns linear values.
+	// There are no 16 bit sRGB formats, so these never drop below 8 bits.
+	bool srgb = false;
+	// The quality budget, as the lowest PSNR in dB a reduced precision format may have against the source to be picked.
+	// 0 never reduces. Around 30 dB keeps photos looking right in 565, a flat colour image usually gets through at higher values too.
+	float minPSNR = 0.f;
+	// How the mip chain is built on the CPU. srgb above also makes the filtering happen in linear light.
+	MipFilter mipFilter = MipFilter::Box;
+};
+
+// What chooseStorage settled on, with the pixels already converted for the glTexImage2D format/type pair.
+struct TextureStorage
+{
+	GLenum internalFormat = GL_RGBA8;
+	GLenum format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+	std::vector<unsigned char> pixels;
+	// Against the source, over every channel the source has. Infinite when nothing was lost, negative for masks made from a multi channel image.
+	double psnr = 0.0;
+};
+
+// Picks the smallest internal format the policy allows whose PSNR stays within budget: GL_RGB565 for RGB, GL_RGB5_A1 or GL_RGBA4 for RGBA
+// (whichever is closer, they're the same size), otherwise the full 8 bit format for the channel count. Runs on the CPU, so call it on a worker.
+TextureStorage chooseStorage(const unsigned char* pixels, int width, int height, int channels, const TexturePolicy& policy);
+// Converts 8 bit texels to the layout chooseStorage uses for internalFormat, so the rest of a mip chain can follow the format picked for level 0.
+void convertToFormat(const unsigned char* pixels, size_t texels, int channels, GLenum internalFormat, std::vector<unsigned char>& out);
+
+// Bytes the GPU holds for one level, for uncompressed and block compressed formats alike. 0 for formats it doesn't know.
+// RGB8 counts as four bytes a texel, because that's how drivers lay it out in practice.
+size_t textureLevelBytes(GLenum internalFormat, uint32_t width, uint32_t height);
+// The same summed over levelCount mip levels.
+size_t textureBytes(GLenum internalFormat, uint32_t width, uint32_t height, uint32_t levelCount);
+// floor(log2(max(width, height))) + 1, the length of a full mip chain.
+uint32_t fullMipCount(uint32_t width, uint32_t height);
+const char* textureFormatName(GLenum internalFormat);
@@ -0,0 +1,277 @@
+#include "TextureLoader.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "TextureFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stb_image.h>
+
+namespace
+{
+	bool hasExtension(const std::string& path, const char* extension)
+	{
+		const size_t length = strlen(extension);
+		return path.size() > length && path.compare(path.size() - length, length, extension) == 0;
+	}
+}
+
+TextureLoader::TextureLoader(ThreadPool& pool)
+	: pool(pool)
+{
+}
+
+GLuint TextureLoader::load(const std::string& path, int sWrap, int tWrap, int magFilter, const TexturePolicy& policy)
+{
+	// Baked and block compressed textures have nothing left to decode, so there's no point sending them to a worker. They go up straight from the mapped file.
+	// Their format was decided when they were made, so the policy doesn't apply.
+	if (hasExtension(path, textureFileExtension) || hasExtension(path, ".dds") || hasExtension(path, ".ktx2"))
+	{
+		GLuint texture = 0;
+		if (hasExtension(path, textureFileExtension))
+		{
+			texture = loadTextureFile(path, sWrap, tWrap, magFilter);
+		}
+		else if (hasExtension(path, ".dds"))
+		{
+			texture = loadDDSFile(path, sWrap, tWrap, magFilter);
+		}
+		else
+		{
+			texture = loadKTX2File(path, sWrap, tWrap, magFilter);
+		}
+		if (texture != 0) record(path, texture);
+		return texture;
+	}
+
+	if (pbos[0] == 0)
+	{
+		glGenBuffers(pboCount, pbos);
+	}
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	glState.bindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sWrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, tWrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+	// Mid grey until the real image arrives. A single texel is complete without mipmaps as long as the max level is 0.
+	const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	glState.bindTexture(GL_TEXTURE_2D, 0);
+
+	pending++;
+	pool.submit([this, texture, path, policy]
+	{
+		// The flip setting is global by default. The _thread version only affects loads on this worker.
+		stbi_set_flip_vertically_on_load_thread(true);
+
+		DecodedImage image;
+		image.texture = texture;
+		image.path = path;
+		int numChannels = 0;
+		unsigned char* data = stbi_load(path.c_str(), &image.width, &image.height, &numChannels, 0);
+		if (data != nullptr)
+		{
+			// Converting to a smaller format and measuring what it costs is a full pass over the image, so it belongs here rather than on the render thread.
+			TextureStorage storage = chooseStorage(data, image.width, image.height, numChannels, policy);
+			image.internalFormat = storage.internalFormat;
+			image.format = storage.format;
+			image.type = storage.type;
+			image.psnr = storage.psnr;
+
+			// The chain is filtered from the full precision image, and each level is converted to the chosen format on its own afterwards.
+			// This job already holds one worker. buildMipChain spreads each level's rows over the rest through parallelFor.
+			MipOptions mipOptions;
+			mipOptions.filter = policy.mipFilter;
+			mipOptions.srgb = policy.srgb;
+			std::vector<std::vector<unsigned char>> levels;
+			buildMipChain(&pool, data, (uint32_t)image.width, (uint32_t)image.height, numChannels, mipOptions, levels);
+			image.pixels.swap(storage.pixels);
+			image.levelOffsets.push_back(0);
+			std::vector<unsigned char> converted;
+			for (size_t i = 1; i < levels.size(); i++)
+			{
+				image.levelOffsets.push_back(image.pixels.size());
+				const size_t texels = (size_t)std::max(image.width >> i, 1) * std::max(image.height >> i, 1);
+				convertToFormat(levels[i].data(), texels, numChannels, image.internalFormat, converted);
+				image.pixels.insert(image.pixels.end(), converted.begin(), converted.end());
+			}
+		}
+		stbi_image_free(data);
+
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		decoded.push_back(std::move(image));
+	});
+
+	return texture;
+}
+
+// Call once per frame on the render thread. Uploads finished images until the byte budget is used up, so a burst of loads is spread over several frames
+// instead of hitching one. At least one image always goes through so a big texture can't get stuck behind the budget.
+void TextureLoader::update(size_t uploadBudgetBytes)
+{
+	std::vector<DecodedImage> ready;
+	{
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		size_t bytes = 0;
+		size_t count = 0;
+		while (count < decoded.size() && (count == 0 || bytes + decoded[count].pixels.size() <= uploadBudgetBytes))
+		{
+			bytes += decoded[count].pixels.size();
+			count++;
+		}
+		ready.assign(std::make_move_iterator(decoded.begin()), std::make_move_iterator(decoded.begin() + count));
+		decoded.erase(decoded.begin(), decoded.begin() + count);
+	}
+
+	for (const DecodedImage& image : ready)
+	{
+		upload(image);
+		pending--;
+	}
+}
+
+// Blocks until every requested texture is decoded and uploaded. The benchmark uses this so textures don't pop in on different frames between runs.
+void TextureLoader::finish()
+{
+	while (pending > 0)
+	{
+		pool.wait();
+		update(~(size_t)0);
+	}
+}
+
+bool TextureLoader::idle() const
+{
+	return pending == 0;
+}
+
+void TextureLoader::upload(const DecodedImage& image)
+{
+	if (image.pixels.empty())
+	{
+		std::cout << "Failed to load texture from " << image.path << '\n';
+		return;
+	}
+
+	// Copy into a pixel unpack buffer, then point glTexImage2D at the buffer instead of client memory. The driver can then do the transfer
+	// asynchronously instead of copying out of our memory before glTexImage2D returns.
+	// Orphaning with glBufferData and mapping unsynchronized means we never wait for the GPU to finish with the previous upload.
+	GLuint pbo = pbos[nextPbo];
+	nextPbo = (nextPbo + 1) % pboCount;
+	glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, image.pixels.size(), nullptr, GL_STREAM_DRAW);
+	void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, image.pixels.size(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	const unsigned char* source = nullptr; // With a buffer bound to GL_PIXEL_UNPACK_BUFFER, this is an offset into the buffer.
+	if (mapped != nullptr)
+	{
+		memcpy(mapped, image.pixels.data(), image.pixels.size());
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	}
+	else
+	{
+		glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		source = image.pixels.data();
+	}
+
+	const uint32_t levelCount = (uint32_t)image.levelOffsets.size();
+	glState.bindTexture(GL_TEXTURE_2D, image.texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Rows of 3 channel and 16 bit images aren't necessarily 4 byte aligned.
+	if (glExt.textureStorage)
+	{
+		// The placeholder was specified with glTexImage2D, which leaves the texture mutable, so it can still be given immutable storage here.
+		glExt.texStorage2D(GL_TEXTURE_2D, (GLsizei)levelCount, image.internalFormat, image.width, image.height);
+	}
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		const GLsizei width = std::max(image.width >> i, 1);
+		const GLsizei height = std::max(image.height >> i, 1);
+		const unsigned char* levelSource = source + image.levelOffsets[i];
+		if (glExt.textureStorage)
+		{
+			glTexSubImage2D(GL_TEXTURE_2D, (GLint)i, 0, 0, width, height, image.format, image.type, levelSource);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, (GLint)i, (GLint)image.internalFormat, width, height, 0, image.format, image.type, levelSource);
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levelCount - 1);
+	glState.bindTexture(GL_TEXTURE_2D, 0);
+
+	TextureRecord entry;
+	entry.path = image.path;
+	entry.width = (uint32_t)image.width;
+	entry.height = (uint32_t)image.height;
+	entry.levelCount = levelCount;
+	entry.internalFormat = image.internalFormat;
+	entry.psnr = image.psnr;
+	records.push_back(entry);
+}
+
+// Files come in with their format and mip count already decided, so read them back from the texture rather than parsing anything twice.
+void TextureLoader::record(const std::string& path, GLuint texture)
+{
+	GLint width = 0;
+	GLint height = 0;
+	GLint internalFormat = 0;
+	GLint maxLevel = 0;
+	glState.bindTexture(GL_TEXTURE_2D, texture);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+	glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+	glState.bindTexture(GL_TEXTURE_2D, 0);
+
+	TextureRecord entry;
+	entry.path = path;
+	entry.width = (uint32_t)width;
+	entry.height = (uint32_t)height;
+	entry.levelCount = std::min((uint32_t)maxLevel + 1, fullMipCount(entry.width, entry.height));
+	entry.internalFormat = (GLenum)internalFormat;
+	entry.psnr = -1.0; // Unknown, there's no source to compare against.
+	records.push_back(entry);
+}
+
+void TextureLoader::printMemoryReport() const
+{
+	size_t total = 0;
+	std::cout << "Texture memory:\n";
+	for (const TextureRecord& entry : records)
+	{
+		const size_t bytes = textureBytes(entry.internalFormat, entry.width, entry.height, entry.levelCount);
+		total += bytes;
+		std::cout << "  " << entry.path << ": " << entry.width << "x" << entry.height << " " << textureFormatName(entry.internalFormat)
+			<< ", " << entry.levelCount << " levels, " << (bytes + 1023) / 1024 << " KB";
+		if (std::isinf(entry.psnr))
+		{
+			std::cout << ", lossless";
+		}
+		else if (entry.psnr >= 0.0)
+		{
+			std::cout << ", " << std::fixed << std::setprecision(1) << entry.psnr << " dB" << std::defaultfloat;
+		}
+		std::cout << '\n';
+	}
+	std::cout << "  " << records.size() << " textures, " << (total + 1023) / 1024 << " KB total\n";
+}
+
+void TextureLoader::destroy()
+{
+	finish();
+	if (pbos[0] != 0)
+	{
+		glDeleteBuffers(pboCount, pbos);
+	}
+	for (int i = 0; i < pboCount; i++)
+	{
+		pbos[i] = 0;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "TextureFormat.h"
+#include "ThreadPool.h"
+
+// Loads textures without blocking the render thread. load() hands back a texture name right away that holds a 1x1 placeholder,
+// decodes the file on the thread pool, and update() later streams the pixels into that same texture through a pixel unpack buffer.
+// Because the name never changes, nothing that already holds it needs to know when the real image shows up.
+// Baked texture files, DDS and KTX2 (see TextureFile.h) skip all of that and are complete by the time load() returns.
+// Decoded images are stored in whatever format the policy settles on (see chooseStorage), picked on the worker along with the decode.
+// The mip chain is built on the workers too (see buildMipChain) and every level is uploaded explicitly, so glGenerateMipmap never runs.
+// Every texture that went through here, however it was loaded, shows up in printMemoryReport().
+class TextureLoader
+{
+public:
+	explicit TextureLoader(ThreadPool& pool);
+
+	GLuint load(const std::string& path, int sWrap = GL_REPEAT, int tWrap = GL_REPEAT, int magFilter = GL_LINEAR, const TexturePolicy& policy = TexturePolicy());
+	void update(size_t uploadBudgetBytes = 8 * 1024 * 1024);
+	void finish();
+	bool idle() const;
+	// One line per texture with its format, size and GPU memory including mips, then the total.
+	void printMemoryReport() const;
+	void destroy();
+
+private:
+	struct DecodedImage
+	{
+		GLuint texture = 0;
+		std::string path;
+		int width = 0;
+		int height = 0;
+		GLenum internalFormat = GL_NONE;
+		GLenum format = GL_NONE;
+		GLenum type = GL_NONE;
+		double psnr = 0.0;
+		// Every mip level back to back. Level i starts at levelOffsets[i].
+		std::vector<unsigned char> pixels;
+		std::vector<size_t> levelOffsets;
+	};
+
+	struct TextureRecord
+	{
+		std::string path;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t levelCount = 0;
+		GLenum internalFormat = GL_NONE;
+		double psnr = 0.0;
+	};
+
+	void upload(const DecodedImage& image);
+	void record(const std::string& path, GLuint texture);
+
+	static const int pboCount = 2;
+
+	ThreadPool& pool;
+	GLuint pbos[pboCount] = {};
+	int nextPbo = 0;
+	size_t pending = 0;
+	std::vector<DecodedImage> decoded;
+	std::vector<TextureRecord> records;
+	mutable std::mutex decodedMutex;
+};
@@ -0,0 +1,166 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+	if (threadCount == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		threadCount = cores > 1 ? cores - 1 : 1;
+	}
+
+	workers.reserve(threadCount);
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	jobAvailable.notify_one();
+}
+
+// Blocks until every submitted job has finished running.
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	jobsDone.wait(lock, [this] { return jobs.empty() && activeJobs == 0; });
+}
+
+void ThreadPool::runRange(size_t count, RangeJob job, const void* context)
+{
+	if (count == 0) return;
+
+	const size_t maxHelpers = count - 1 < workers.size() ? count - 1 : workers.size();
+	Range* range = nullptr;
+	if (maxHelpers > 0)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (Range& candidate : ranges)
+		{
+			if (candidate.active) continue;
+			range = &candidate;
+			range->active = true;
+			range->job = job;
+			range->context = context;
+			range->count = count;
+			range->maxHelpers = maxHelpers;
+			range->helpers = 0;
+			range->next = 0;
+			range->done = 0;
+			break;
+		}
+	}
+	if (range == nullptr)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			job(context, i);
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < maxHelpers; i++)
+	{
+		jobAvailable.notify_one();
+	}
+	runIndices(*range);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	rangeDone.wait(lock, [range] { return range->done == range->count && range->helpers == 0; });
+	range->active = false;
+}
+
+void ThreadPool::runIndices(Range& range)
+{
+	size_t index = 0;
+	while ((index = range.next++) < range.count)
+	{
+		range.job(range.context, index);
+		if (++range.done == range.count)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			rangeDone.notify_all();
+		}
+	}
+}
+
+// A range a worker can still help with. Called with the mutex held.
+ThreadPool::Range* ThreadPool::openRange()
+{
+	for (Range& range : ranges)
+	{
+		if (range.active && range.helpers < range.maxHelpers && range.next < range.count) return &range;
+	}
+	return nullptr;
+}
+
+unsigned int ThreadPool::size() const
+{
+	return (unsigned int)workers.size();
+}
+
+void ThreadPool::workerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		Range* range = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			// A parallelFor has someone waiting on it right now, so it goes ahead of anything queued.
+			jobAvailable.wait(lock, [this, &range] { return (range = openRange()) != nullptr || stopping || !jobs.empty(); });
+			if (range != nullptr)
+			{
+				range->helpers++;
+			}
+			else
+			{
+				if (stopping && jobs.empty()) return;
+				job = std::move(jobs.front());
+				jobs.pop_front();
+				activeJobs++;
+			}
+		}
+
+		if (range != nullptr)
+		{
+			runIndices(*range);
+			std::lock_guard<std::mutex> lock(mutex);
+			range->helpers--;
+			if (range->helpers == 0)
+			{
+				rangeDone.notify_all();
+			}
+			continue;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			activeJobs--;
+			if (jobs.empty() && activeJobs == 0)
+			{
+				jobsDone.notify_all();
+			}
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A fixed set of worker threads pulling jobs off one queue. Jobs must not touch GL, only the thread that owns the context can.
+class ThreadPool
+{
+public:
+	// 0 picks one thread per core, leaving one core for the render thread.
+	explicit ThreadPool(unsigned int threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void submit(std::function<void()> job);
+	void wait();
+	// Runs job(0) .. job(count - 1) spread over the workers and the calling thread, and returns once all of them are done.
+	// Unlike wait(), this only waits for its own jobs, so a long texture decode sitting in the queue can't hold up the frame.
+	// It runs every frame, so it doesn't allocate: job is called through a pointer to the caller's own callable, and the range
+	// lives in one of the pool's fixed slots. When every slot is taken (many nested or concurrent calls) the caller runs it all itself.
+	template<typename Job>
+	void parallelFor(size_t count, Job&& job)
+	{
+		typedef typename std::remove_reference<Job>::type Callable;
+		runRange(count, [](const void* context, size_t index) { (*(Callable*)context)(index); }, &job);
+	}
+	unsigned int size() const;
+
+private:
+	typedef void (*RangeJob)(const void* context, size_t index);
+
+	// One parallelFor in progress. Workers join while it has indices left and helper places free, and the caller only hands the slot
+	// back once the last helper has left, so nobody can still be looking at it when the next parallelFor reuses it.
+	struct Range
+	{
+		bool active = false;
+		RangeJob job = nullptr;
+		const void* context = nullptr;
+		size_t count = 0;
+		size_t maxHelpers = 0;
+		size_t helpers = 0;
+		std::atomic<size_t> next{ 0 };
+		std::atomic<size_t> done{ 0 };
+	};
+	static const size_t maxRanges = 16;
+
+	void runRange(size_t count, RangeJob job, const void* context);
+	void runIndices(Range& range);
+	Range* openRange();
+	void workerLoop();
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable jobsDone;
+	std::condition_variable rangeDone;
+	Range ranges[maxRanges];
+	size_t activeJobs = 0;
+	bool stopping = false;
+};
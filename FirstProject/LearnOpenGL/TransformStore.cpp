@@ -0,0 +1,98 @@
+#include "TransformStore.h"
+
+void TransformStore::reserve(size_t count)
+{
+	positions.reserve(count);
+	rotations.reserve(count);
+	scales.reserve(count);
+	parents.reserve(count);
+	worlds.reserve(count);
+	dirty.reserve(count);
+}
+
+TransformId TransformStore::create(const glm::vec3& position, TransformId parent)
+{
+	const TransformId id = (TransformId)positions.size();
+	positions.push_back(position);
+	rotations.push_back(glm::quat(1.f, 0.f, 0.f, 0.f));
+	scales.push_back(glm::vec3(1.f));
+	// A parent created after its child would break the single pass order, so anything else is treated as a root.
+	parents.push_back(parent < id ? parent : noParentTransform);
+	worlds.push_back(glm::mat4(1.f));
+	dirty.push_back(0);
+	markDirty(id);
+	return id;
+}
+
+void TransformStore::setPosition(TransformId id, const glm::vec3& position)
+{
+	positions[id] = position;
+	markDirty(id);
+}
+
+void TransformStore::setRotation(TransformId id, const glm::quat& rotation)
+{
+	rotations[id] = rotation;
+	markDirty(id);
+}
+
+void TransformStore::setScale(TransformId id, const glm::vec3& scale)
+{
+	scales[id] = scale;
+	markDirty(id);
+}
+
+void TransformStore::markDirty(TransformId id)
+{
+	dirty[id] = 1;
+	if (!anyDirty || id < firstDirty) firstDirty = id;
+	anyDirty = true;
+}
+
+void TransformStore::update()
+{
+	lastUpdateCount = 0;
+	if (!anyDirty) return;
+
+	// Nothing before the first dirty transform can be affected, since parents always come first.
+	for (size_t i = firstDirty; i < positions.size(); i++)
+	{
+		const TransformId parent = parents[i];
+		if (parent != noParentTransform && dirty[parent])
+		{
+			dirty[i] = 1;
+		}
+		if (!dirty[i]) continue;
+
+		// T * R * S, built directly instead of through three matrix multiplies.
+		glm::mat4 local = glm::mat4_cast(rotations[i]);
+		local[0] *= scales[i].x;
+		local[1] *= scales[i].y;
+		local[2] *= scales[i].z;
+		local[3] = glm::vec4(positions[i], 1.f);
+		worlds[i] = parent != noParentTransform ? worlds[parent] * local : local;
+		lastUpdateCount++;
+	}
+
+	// Flags are cleared after the pass, so children further on could still see their parent's.
+	for (size_t i = firstDirty; i < dirty.size(); i++)
+	{
+		dirty[i] = 0;
+	}
+	anyDirty = false;
+}
+
+const glm::mat4& TransformStore::getWorld(TransformId id) const
+{
+	return worlds[id];
+}
+
+size_t TransformStore::size() const
+{
+	return positions.size();
+}
+
+size_t TransformStore::getLastUpdateCount() const
+{
+	return lastUpdateCount;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+typedef uint32_t TransformId;
+const TransformId noParentTransform = 0xffffffffu;
+
+// Local position/rotation/scale and the cached world matrix for every object, each in its own contiguous array.
+// A transform can only be parented to one that already exists, so ids are handed out parent before child and the
+// world matrices can all be brought up to date in a single forward pass: by the time a child is reached its parent is done.
+// Only transforms that were changed, or whose parent's world changed, are recomputed. Something that never moves is computed
+// once, and after that update() doesn't even look at it unless something created before it moved.
+class TransformStore
+{
+public:
+	void reserve(size_t count);
+	TransformId create(const glm::vec3& position, TransformId parent = noParentTransform);
+
+	void setPosition(TransformId id, const glm::vec3& position);
+	void setRotation(TransformId id, const glm::quat& rotation);
+	void setScale(TransformId id, const glm::vec3& scale);
+
+	// Recomputes the world matrices of everything marked since the last update, and of their descendants.
+	void update();
+
+	const glm::mat4& getWorld(TransformId id) const;
+	size_t size() const;
+	// How many world matrices the last update() recomputed.
+	size_t getLastUpdateCount() const;
+
+private:
+	void markDirty(TransformId id);
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::quat> rotations;
+	std::vector<glm::vec3> scales;
+	std::vector<TransformId> parents;
+	std::vector<glm::mat4> worlds;
+	// Set by the setters. During update() it also spreads to children, so a child sees its parent's flag before it is cleared.
+	std::vector<uint8_t> dirty;
+	size_t firstDirty = 0;
+	bool anyDirty = false;
+	size_t lastUpdateCount = 0;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+// Packed attribute types. Each one wraps the bits a glm packing function returns, so the layout below can tell them apart by type.
+// The shader still sees plain floats, GL unpacks them during vertex fetch.
+
+// 4 half floats. The 4th component pads to 8 bytes and reads as w = 1.
+struct Half4
+{
+	uint64_t bits = 0;
+	Half4() = default;
+	explicit Half4(const glm::vec3& v) : bits(glm::packHalf4x16(glm::vec4(v, 1.f))) {}
+};
+
+// Signed normalized 10:10:10:2, laid out for GL_INT_2_10_10_10_REV. Plenty of precision for unit vectors in 4 bytes instead of 12.
+struct PackedNormal
+{
+	uint32_t bits = 0;
+	PackedNormal() = default;
+	explicit PackedNormal(const glm::vec3& v) : bits(glm::packSnorm3x10_1x2(glm::vec4(v, 0.f))) {}
+};
+
+// Two unsigned normalized 16-bit values. Texture coords have to be in [0, 1], anything outside is clamped.
+struct Unorm16x2
+{
+	uint32_t bits = 0;
+	Unorm16x2() = default;
+	explicit Unorm16x2(const glm::vec2& v) : bits(glm::packUnorm2x16(v)) {}
+};
+
+// Four unsigned normalized bytes, for colors.
+struct Unorm8x4
+{
+	uint32_t bits = 0;
+	Unorm8x4() = default;
+	explicit Unorm8x4(const glm::vec3& v) : bits(glm::packUnorm4x8(glm::vec4(v, 1.f))) {}
+};
+
+// How each member type is described to glVertexAttribPointer.
+template<typename T> struct VertexAttribFormat;
+template<> struct VertexAttribFormat<float> { static const GLint size = 1; static const GLenum type = GL_FLOAT; static const GLboolean normalized = GL_FALSE; };
+template<> struct VertexAttribFormat<glm::vec2> { static const GLint size = 2; static const GLenum type = GL_FLOAT; static const GLboolean normalized = GL_FALSE; };
+template<> struct VertexAttribFormat<glm::vec3> { static const GLint size = 3; static const GLenum type = GL_FLOAT; static const GLboolean normalized = GL_FALSE; };
+template<> struct VertexAttribFormat<glm::vec4> { static const GLint size = 4; static const GLenum type = GL_FLOAT; static const GLboolean normalized = GL_FALSE; };
+template<> struct VertexAttribFormat<Half4> { static const GLint size = 4; static const GLenum type = GL_HALF_FLOAT; static const GLboolean normalized = GL_FALSE; };
+template<> struct VertexAttribFormat<PackedNormal> { static const GLint size = 4; static const GLenum type = GL_INT_2_10_10_10_REV; static const GLboolean normalized = GL_TRUE; };
+template<> struct VertexAttribFormat<Unorm16x2> { static const GLint size = 2; static const GLenum type = GL_UNSIGNED_SHORT; static const GLboolean normalized = GL_TRUE; };
+template<> struct VertexAttribFormat<Unorm8x4> { static const GLint size = 4; static const GLenum type = GL_UNSIGNED_BYTE; static const GLboolean normalized = GL_TRUE; };
+
+// The attribute setup for vertex struct V, built from its members instead of hand counted strides and offsets:
+//   VertexLayout<PackedVertex>().add(0, &PackedVertex::position).add(2, &PackedVertex::texCoord).apply();
+// A member type without a VertexAttribFormat specialization is a compile error, so a layout can't silently disagree with its struct.
+template<typename V>
+class VertexLayout
+{
+public:
+	struct Attribute
+	{
+		GLuint location;
+		GLint size;
+		GLenum type;
+		GLboolean normalized;
+		size_t offset;
+	};
+
+	template<typename T>
+	VertexLayout& add(GLuint location, T V::* member)
+	{
+		// The offset is measured on a real object, which works for any member without offsetof's standard layout rules.
+		static const V probe = V();
+		Attribute attribute;
+		attribute.location = location;
+		attribute.size = VertexAttribFormat<T>::size;
+		attribute.type = VertexAttribFormat<T>::type;
+		attribute.normalized = VertexAttribFormat<T>::normalized;
+		attribute.offset = (size_t)((const char*)&(probe.*member) - (const char*)&probe);
+		attributes.push_back(attribute);
+		return *this;
+	}
+
+	// Points the attributes at the buffer bound to GL_ARRAY_BUFFER, for the VAO that is bound.
+	void apply(size_t bufferOffset = 0) const
+	{
+		for (const Attribute& attribute : attributes)
+		{
+			glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized, sizeof(V), (void*)(bufferOffset + attribute.offset));
+			glEnableVertexAttribArray(attribute.location);
+		}
+	}
+
+	const std::vector<Attribute>& getAttributes() const
+	{
+		return attributes;
+	}
+
+private:
+	std::vector<Attribute> attributes;
+};
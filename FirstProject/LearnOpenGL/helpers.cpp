@@ -1,4 +1,23 @@
 #include "helpers.h"
+#include <cerrno>
+#include <cmath>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#if defined(__AVX2__)
+#define HELPERS_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HELPERS_SSE2
+#include <emmintrin.h>
+#endif
 
 // OpenGL guarantees 16 4-component vertex attributes, but more may be available depending on hardware.
 void printNumberOfVertexAttributes()
@@ -32,6 +51,61 @@ bool readFile(const std::string& path, std::string& outSrc)
 	return success;
 }
 
+// Succeeds if the directory is there afterwards, whether or not we were the ones who made it.
+bool makeDirectory(const char* path)
+{
+#ifdef _WIN32
+	int result = _mkdir(path);
+#else
+	int result = mkdir(path, 0755);
+#endif
+	if (result != 0 && errno != EEXIST)
+	{
+		std::cout << "Could not create directory " << path << '\n';
+		return false;
+	}
+	return true;
+}
+
+bool cpuSupportsBuild()
+{
+#if defined(HELPERS_AVX2) && defined(_MSC_VER)
+	// /arch:AVX2 also lets the compiler use FMA, so that has to be there too. Leaf 7 EBX bit 5 is AVX2, leaf 1 ECX has FMA (12),
+	// OSXSAVE (27) and AVX (28), and XCR0 bits 1-2 say the OS saves the ymm registers across context switches.
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+	__cpuid(info, 1);
+	const int leaf1 = (1 << 12) | (1 << 27) | (1 << 28);
+	if ((info[2] & leaf1) != leaf1 || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif defined(HELPERS_AVX2) && defined(__GNUC__)
+	return __builtin_cpu_supports("avx2") != 0;
+#else
+	return true;
+#endif
+}
+
+// 64 bit FNV-1a. Not cryptographic, but cheap and spreads small changes in the input well enough to key caches.
+// Pass the previous result back in as hash to keep hashing across several buffers.
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
 glm::vec3 zAxis()
 {
 	return glm::vec3(0.f, 0.f, 1.f);
@@ -89,3 +163,231 @@ glm::mat4 pProj(float fovDeg, float width, float height, float near, float far)
 	// fov is the vertical angle, i.e. around x axis.
 	return glm::perspective(glm::radians(fovDeg), width / height, near, far);
 }
+
+namespace
+{
+	// Rodrigues' formula, the same matrix glm::rotate builds, with the scale folded into the columns.
+	void composeScalar(const glm::vec3& trans, const glm::vec3& axis, float angle, const glm::vec3& scale, glm::mat4& out)
+	{
+		glm::vec3 a = glm::normalize(axis);
+		float c = std::cos(angle);
+		float s = std::sin(angle);
+		glm::vec3 t = a * (1.f - c);
+		out[0] = glm::vec4(t.x * a.x + c, t.x * a.y + s * a.z, t.x * a.z - s * a.y, 0.f) * scale.x;
+		out[1] = glm::vec4(t.y * a.x - s * a.z, t.y * a.y + c, t.y * a.z + s * a.x, 0.f) * scale.y;
+		out[2] = glm::vec4(t.z * a.x + s * a.y, t.z * a.y - s * a.x, t.z * a.z + c, 0.f) * scale.z;
+		out[3] = glm::vec4(trans, 1.f);
+	}
+
+#ifdef HELPERS_SSE2
+	// The same handful of operations for 4 and 8 lanes, so the kernel below is written once for both widths.
+	inline __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+	inline __m128 sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+	inline __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+	inline __m128 div(__m128 a, __m128 b) { return _mm_div_ps(a, b); }
+	inline __m128 sqrt(__m128 a) { return _mm_sqrt_ps(a); }
+	inline __m128 greater(__m128 a, __m128 b) { return _mm_cmpgt_ps(a, b); }
+	inline __m128 select(__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	inline __m128 roundNearest(__m128 a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+	inline void splat(float value, __m128& out) { out = _mm_set1_ps(value); }
+#endif
+#ifdef HELPERS_AVX2
+	inline __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+	inline __m256 sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+	inline __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+	inline __m256 div(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+	inline __m256 sqrt(__m256 a) { return _mm256_sqrt_ps(a); }
+	inline __m256 greater(__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	inline __m256 select(__m256 mask, __m256 a, __m256 b) { return _mm256_blendv_ps(b, a, mask); }
+	inline __m256 roundNearest(__m256 a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	inline void splat(float value, __m256& out) { out = _mm256_set1_ps(value); }
+#endif
+
+#ifdef HELPERS_SSE2
+	template<typename V>
+	V constant(float value)
+	{
+		V v;
+		splat(value, v);
+		return v;
+	}
+
+	// Sin and cos together. The angle is brought into [-pi, pi] by subtracting whole turns of 2pi, then folded into [-pi/2, pi/2]
+	// where short Taylor series are good to about 1e-7.
+	// 2pi is split Cody-Waite style: the first two parts have only 8 and 12 significant bits, so turns * part is exact for up to
+	// 4096 turns (about 25000 radians) and the subtraction loses nothing. The third part carries the rest of 2pi. Past that the
+	// products start rounding and the error grows with the angle.
+	template<typename V>
+	void sinCos(V x, V& outSin, V& outCos)
+	{
+		V turns = roundNearest(mul(x, constant<V>(0.159154943f)));
+		x = sub(x, mul(turns, constant<V>(6.28125f)));
+		x = sub(x, mul(turns, constant<V>(1.935482025e-3f)));
+		x = sub(x, mul(turns, constant<V>(-1.748455531e-7f)));
+
+		const V halfPi = constant<V>(1.57079633f);
+		const V pi = constant<V>(3.14159265f);
+		V above = greater(x, halfPi);
+		V below = greater(sub(constant<V>(0.f), halfPi), x);
+		x = select(above, sub(pi, x), select(below, sub(sub(constant<V>(0.f), pi), x), x));
+		V cosSign = select(above, constant<V>(-1.f), select(below, constant<V>(-1.f), constant<V>(1.f)));
+
+		V x2 = mul(x, x);
+		V s = constant<V>(-1.f / 39916800.f);
+		s = add(mul(s, x2), constant<V>(1.f / 362880.f));
+		s = add(mul(s, x2), constant<V>(-1.f / 5040.f));
+		s = add(mul(s, x2), constant<V>(1.f / 120.f));
+		s = add(mul(s, x2), constant<V>(-1.f / 6.f));
+		s = add(mul(s, x2), constant<V>(1.f));
+		outSin = mul(s, x);
+
+		V c = constant<V>(1.f / 479001600.f);
+		c = add(mul(c, x2), constant<V>(-1.f / 3628800.f));
+		c = add(mul(c, x2), constant<V>(1.f / 40320.f));
+		c = add(mul(c, x2), constant<V>(-1.f / 720.f));
+		c = add(mul(c, x2), constant<V>(1.f / 24.f));
+		c = add(mul(c, x2), constant<V>(-0.5f));
+		c = add(mul(c, x2), constant<V>(1.f));
+		outCos = mul(c, cosSign);
+	}
+
+	// The vector type and lane count for one width. __m128 and __m256 carry alignment attributes that a template argument
+	// would drop (GCC warns about it), so the structs below are templated on these instead of on the vector types.
+	struct Sse2Lanes
+	{
+		typedef __m128 V;
+		static const int count = 4;
+	};
+#ifdef HELPERS_AVX2
+	struct Avx2Lanes
+	{
+		typedef __m256 V;
+		static const int count = 8;
+	};
+#endif
+
+	// Columns 0-2 of the rotation/scale part and the translation, one lane per matrix.
+	template<typename Width>
+	struct MatrixLanes
+	{
+		typename Width::V m[3][3]; // m[column][row]
+		typename Width::V trans[3];
+	};
+
+	// Gathers Width::count matrices' worth of inputs into lanes (the inputs are AoS, the math wants SoA) and composes them.
+	template<typename Width>
+	void composeLanes(const glm::vec3* translations, const glm::vec3* axes, const float* angles, const glm::vec3* scales, MatrixLanes<Width>& out)
+	{
+		typedef typename Width::V V;
+		const int Lanes = Width::count;
+		alignas(32) float in[10][Lanes];
+		for (int i = 0; i < Lanes; i++)
+		{
+			in[0][i] = translations[i].x;
+			in[1][i] = translations[i].y;
+			in[2][i] = translations[i].z;
+			in[3][i] = axes[i].x;
+			in[4][i] = axes[i].y;
+			in[5][i] = axes[i].z;
+			in[6][i] = angles[i];
+			in[7][i] = scales != nullptr ? scales[i].x : 1.f;
+			in[8][i] = scales != nullptr ? scales[i].y : 1.f;
+			in[9][i] = scales != nullptr ? scales[i].z : 1.f;
+		}
+		V v[10];
+		for (int k = 0; k < 10; k++)
+		{
+			v[k] = *(const V*)in[k];
+		}
+
+		V inverseLength = div(constant<V>(1.f), sqrt(add(add(mul(v[3], v[3]), mul(v[4], v[4])), mul(v[5], v[5]))));
+		V x = mul(v[3], inverseLength);
+		V y = mul(v[4], inverseLength);
+		V z = mul(v[5], inverseLength);
+		V s;
+		V c;
+		sinCos(v[6], s, c);
+		V oneMinusC = sub(constant<V>(1.f), c);
+		V tx = mul(x, oneMinusC);
+		V ty = mul(y, oneMinusC);
+		V tz = mul(z, oneMinusC);
+
+		out.m[0][0] = mul(add(mul(tx, x), c), v[7]);
+		out.m[0][1] = mul(add(mul(tx, y), mul(s, z)), v[7]);
+		out.m[0][2] = mul(sub(mul(tx, z), mul(s, y)), v[7]);
+		out.m[1][0] = mul(sub(mul(ty, x), mul(s, z)), v[8]);
+		out.m[1][1] = mul(add(mul(ty, y), c), v[8]);
+		out.m[1][2] = mul(add(mul(ty, z), mul(s, x)), v[8]);
+		out.m[2][0] = mul(add(mul(tz, x), mul(s, y)), v[9]);
+		out.m[2][1] = mul(sub(mul(tz, y), mul(s, x)), v[9]);
+		out.m[2][2] = mul(add(mul(tz, z), c), v[9]);
+		out.trans[0] = v[0];
+		out.trans[1] = v[1];
+		out.trans[2] = v[2];
+	}
+
+	// A 4x4 transpose turns (all matrices' x, all y, all z, w) into one column per matrix.
+	void storeColumn(__m128 x, __m128 y, __m128 z, __m128 w, glm::mat4* out, int column)
+	{
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_mm_storeu_ps(&out[0][column][0], x);
+		_mm_storeu_ps(&out[1][column][0], y);
+		_mm_storeu_ps(&out[2][column][0], z);
+		_mm_storeu_ps(&out[3][column][0], w);
+	}
+
+	void store4(const __m128 m[3][3], const __m128 trans[3], glm::mat4* out)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		for (int column = 0; column < 3; column++)
+		{
+			storeColumn(m[column][0], m[column][1], m[column][2], zero, out, column);
+		}
+		storeColumn(trans[0], trans[1], trans[2], _mm_set1_ps(1.f), out, 3);
+	}
+#endif
+}
+
+void trsBatch(const glm::vec3* translations, const glm::vec3* axes, const float* angles, const glm::vec3* scales, glm::mat4* out, size_t count)
+{
+	size_t i = 0;
+#if defined(HELPERS_AVX2)
+	for (; i + 8 <= count; i += 8)
+	{
+		MatrixLanes<Avx2Lanes> lanes;
+		composeLanes<Avx2Lanes>(translations + i, axes + i, angles + i, scales != nullptr ? scales + i : nullptr, lanes);
+		// The transpose works on 4 lanes, so each half of the 8 lanes is stored on its own.
+		for (int half = 0; half < 2; half++)
+		{
+			__m128 m[3][3];
+			__m128 trans[3];
+			for (int column = 0; column < 3; column++)
+			{
+				for (int row = 0; row < 3; row++)
+				{
+					m[column][row] = half == 0 ? _mm256_castps256_ps128(lanes.m[column][row]) : _mm256_extractf128_ps(lanes.m[column][row], 1);
+				}
+				trans[column] = half == 0 ? _mm256_castps256_ps128(lanes.trans[column]) : _mm256_extractf128_ps(lanes.trans[column], 1);
+			}
+			store4(m, trans, out + i + half * 4);
+		}
+	}
+#endif
+#if defined(HELPERS_SSE2)
+	for (; i + 4 <= count; i += 4)
+	{
+		MatrixLanes<Sse2Lanes> lanes;
+		composeLanes<Sse2Lanes>(translations + i, axes + i, angles + i, scales != nullptr ? scales + i : nullptr, lanes);
+		store4(lanes.m, lanes.trans, out + i);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		composeScalar(translations[i], axes[i], angles[i], scales != nullptr ? scales[i] : glm::vec3(1.f), out[i]);
+	}
+}
+
+void trBatch(const glm::vec3* translations, const glm::vec3* axes, const float* angles, glm::mat4* out, size_t count)
+{
+	trsBatch(translations, axes, angles, nullptr, out, count);
+}
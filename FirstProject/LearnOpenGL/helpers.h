@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include <glm.hpp>
@@ -9,6 +10,18 @@
 
 void printNumberOfVertexAttributes();
 bool readFile(const std::string& path, std::string& outSrc);
+bool makeDirectory(const char* path);
+// False when the build targets AVX2 (the project compiles with /arch:AVX2) and this CPU or OS can't run it. main checks this
+// before anything else, since the alternative is an illegal instruction somewhere later.
+bool cpuSupportsBuild();
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+
+// The same hash as fnv1a over the characters of str (without the terminator), but usable at compile time.
+// Passing the result as a template argument guarantees the hashing happens in the compiler and never at runtime.
+constexpr uint64_t hashName(const char* str, uint64_t hash = 14695981039346656037ull)
+{
+	return *str == 0 ? hash : hashName(str + 1, (hash ^ (unsigned char)*str) * 1099511628211ull);
+}
 
 glm::vec3 zAxis();
 glm::mat4 t(glm::vec3 trans);
@@ -18,5 +31,12 @@ glm::mat4 ts(glm::vec3 trans, glm::vec3 scale);
 glm::mat4 ts(glm::vec3 trans, float scale);
 glm::mat4 trs(glm::vec3 trans, glm::vec3 axis, float angle, float scale);
 glm::mat4 trs(glm::vec3 trans, glm::vec3 axis, float angle, glm::vec3 scale);
+
+// Batch versions of trs. Builds out[i] = translate(translations[i]) * rotate(angles[i], axes[i]) * scale(scales[i]) for count matrices.
+// Axes don't have to be normalized. Pass nullptr for scales to get tr instead. Sin/cos and the rotation are computed 8 (AVX2) or
+// 4 (SSE2) matrices at a time, depending on what the build targets, with a scalar loop for the rest and for other targets.
+// There are no batch versions of t, r and ts: zero angles give t and ts, zero translations give r.
+void trsBatch(const glm::vec3* translations, const glm::vec3* axes, const float* angles, const glm::vec3* scales, glm::mat4* out, size_t count);
+void trBatch(const glm::vec3* translations, const glm::vec3* axes, const float* angles, glm::mat4* out, size_t count);
 glm::mat4 oProj(float minusX, float x, float minusY, float y, float minusZ, float z);
 glm::mat4 pProj(float fovDeg, float width, float height, float near, float far);
\ No newline at end of file
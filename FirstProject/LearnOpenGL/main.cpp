@@ -2,8 +2,32 @@
 #include <glfw3.h>
 #include <iostream>
 #include <__msvc_ostream.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
 #include "helpers.h"
 #include "shader.h"
+#include "InstanceBuffer.h"
+#include "RingBuffer.h"
+#include "CameraBlock.h"
+#include "Benchmark.h"
+#include "ThreadPool.h"
+#include "TextureLoader.h"
+#include "GLExtensions.h"
+#include "ShaderManager.h"
+#include "GLState.h"
+#include "RenderQueue.h"
+#include "CommandList.h"
+#include "GeometryArena.h"
+#include "Meshes.h"
+#include "MultiDraw.h"
+#include "FrustumCuller.h"
+#include "SpatialIndex.h"
+#include "TransformStore.h"
+#include "MaterialAtlas.h"
+#include "TextureFile.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -19,14 +43,9 @@ void processInput(GLFWwindow* window, float& mixStrength, const float deltaTime)
 void mouseCallback(GLFWwindow* window, double xPos, double yPos);
 void scrollCallback(GLFWwindow* window, double xOffset, double yOffset);
 void drawTriangle();
-GLuint getTriangleVAO();
-GLuint getRectangleVAO(float texScale, float texOffset);
-GLuint getTwoTrianglesVAO();
-GLuint getTriangleTwoVAO();
-GLuint getTriangleVAOWithTexCoord();
-GLuint getBoxVAO();
 
-GLuint createTex(const char* texPath, int sWrap = GL_REPEAT, int tWrap = GL_REPEAT, int magFilter = GL_LINEAR);
+std::vector<glm::vec3> buildCubeField(int count);
+float cubeRotation(int index);
 
 float deltaTime = 0.f;
 float lastFrame = 0.f;
@@ -35,12 +54,203 @@ float lastY = 300;
 bool firstMouse = true;
 FlyCamera camera(800.f / 600.f);
 
-int main()
+// Run with --instanced to draw the cube field with one instanced draw call, or --per-draw (the default) for one draw per cube.
+// --threaded also draws one cube per draw call, but the worker threads record the draws into command lists that the main thread replays.
+// --multi-draw sends every object in one glMultiDrawElementsIndirect call, whatever mesh it uses (one instanced draw per mesh on GL 3.3).
+// --cubes N grows the field past the original ten cubes so the paths can be compared at scale.
+// --mixed-meshes swaps some of the cubes for the other meshes in the arena, so the field isn't all the same mesh.
+bool useInstancing = false;
+bool useThreadedRecording = false;
+bool useMultiDraw = false;
+bool mixedMeshes = false;
+int cubeCount = 10;
+// --no-cull draws the whole field instead of only what the camera can see.
+// --bvh culls through a bounding volume hierarchy instead of testing every cube. It also enables P, which prints the cube under the
+// crosshair and how many cubes are within 5 units of the camera.
+bool useCulling = true;
+bool useSpatialIndex = false;
+// --texture-array packs both textures into one array texture (see MaterialAtlas), so a frame binds one texture instead of two.
+bool useTextureArray = false;
+
+// --benchmark runs a fixed number of frames (--frames N) with a fixed time step and no input, so frame N always draws the same thing.
+// It creates the context through OSMesa, on GLFW's null platform by default (--headless null), so it runs on machines without a display or GPU.
+// --headless osmesa keeps the native platform but still renders through OSMesa into a hidden window.
+// Per-frame CPU and GPU times are written to --benchmark-out, as JSON if the path ends in .json and CSV otherwise.
+bool benchmark = false;
+int benchmarkFrames = 600;
+std::string benchmarkOut = "benchmark.csv";
+std::string headlessPlatform = "null";
+const float fixedTimeStep = 1.f / 60.f;
+// --transform-benchmark N times trs() against trsBatch() on N matrices and exits without opening a window.
+int transformBenchmarkCount = 0;
+// --cull-benchmark N times frustum culling N spheres, reports whether it made the budget and exits without opening a window.
+int cullBenchmarkCount = 0;
+// --bake-textures converts every texture the scene uses into a baked texture file next to the source image and exits.
+// --baked-textures then loads those files instead, so startup maps and uploads them rather than decoding and mipmapping.
+// Adding --compress to --bake-textures stores them block compressed (BC1 or BC3), which the context has to support to load them.
+bool bakeTextures = false;
+bool compressBakedTextures = false;
+// --texture-budget DB lets decoded textures drop to 16 bit formats as long as they stay above DB of PSNR (see TexturePolicy).
+// The memory each texture ended up taking is printed on exit.
+float textureBudget = 0.f;
+// Mip chains are built on the CPU with a box filter. --kaiser-mips switches the scene textures to the sharper Kaiser filter.
+bool useKaiserMips = false;
+bool useBakedTextures = false;
+const char* const sceneTextures[] = { "./Resources/container.jpg", "./Resources/awesomeface.png" };
+
+void parseArgs(int argc, char** argv)
 {
-	glfwInit();
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--instanced") == 0)
+		{
+			useInstancing = true;
+			useThreadedRecording = false;
+			useMultiDraw = false;
+		}
+		else if (strcmp(argv[i], "--per-draw") == 0)
+		{
+			useInstancing = false;
+			useThreadedRecording = false;
+			useMultiDraw = false;
+		}
+		else if (strcmp(argv[i], "--threaded") == 0)
+		{
+			useInstancing = false;
+			useThreadedRecording = true;
+			useMultiDraw = false;
+		}
+		else if (strcmp(argv[i], "--multi-draw") == 0)
+		{
+			useInstancing = false;
+			useThreadedRecording = false;
+			useMultiDraw = true;
+		}
+		else if (strcmp(argv[i], "--mixed-meshes") == 0)
+		{
+			mixedMeshes = true;
+		}
+		else if (strcmp(argv[i], "--no-cull") == 0)
+		{
+			useCulling = false;
+		}
+		else if (strcmp(argv[i], "--bvh") == 0)
+		{
+			useSpatialIndex = true;
+		}
+		else if (strcmp(argv[i], "--texture-array") == 0)
+		{
+			useTextureArray = true;
+		}
+		else if (strcmp(argv[i], "--cubes") == 0 && i + 1 < argc)
+		{
+			cubeCount = atoi(argv[++i]);
+			cubeCount = cubeCount < 1 ? 1 : cubeCount;
+		}
+		else if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			benchmark = true;
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			benchmarkFrames = atoi(argv[++i]);
+			benchmarkFrames = benchmarkFrames < 1 ? 1 : benchmarkFrames;
+		}
+		else if (strcmp(argv[i], "--benchmark-out") == 0 && i + 1 < argc)
+		{
+			benchmarkOut = argv[++i];
+		}
+		else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+		{
+			headlessPlatform = argv[++i];
+		}
+		else if (strcmp(argv[i], "--transform-benchmark") == 0 && i + 1 < argc)
+		{
+			transformBenchmarkCount = atoi(argv[++i]);
+			transformBenchmarkCount = transformBenchmarkCount < 1 ? 1 : transformBenchmarkCount;
+		}
+		else if (strcmp(argv[i], "--cull-benchmark") == 0 && i + 1 < argc)
+		{
+			cullBenchmarkCount = atoi(argv[++i]);
+			cullBenchmarkCount = cullBenchmarkCount < 1 ? 1 : cullBenchmarkCount;
+		}
+		else if (strcmp(argv[i], "--bake-textures") == 0)
+		{
+			bakeTextures = true;
+		}
+		else if (strcmp(argv[i], "--compress") == 0)
+		{
+			compressBakedTextures = true;
+		}
+		else if (strcmp(argv[i], "--texture-budget") == 0 && i + 1 < argc)
+		{
+			textureBudget = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--kaiser-mips") == 0)
+		{
+			useKaiserMips = true;
+		}
+		else if (strcmp(argv[i], "--baked-textures") == 0)
+		{
+			useBakedTextures = true;
+		}
+		else
+		{
+			std::cout << "Ignoring unknown argument " << argv[i] << '\n';
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (!cpuSupportsBuild())
+	{
+		std::cout << "This build needs a CPU with AVX2\n";
+		return -1;
+	}
+	parseArgs(argc, argv);
+	if (transformBenchmarkCount > 0)
+	{
+		runTransformBenchmark((size_t)transformBenchmarkCount);
+		return 0;
+	}
+	if (cullBenchmarkCount > 0)
+	{
+		runCullBenchmark((size_t)cullBenchmarkCount);
+		return 0;
+	}
+	if (bakeTextures)
+	{
+		bool success = true;
+		for (const char* source : sceneTextures)
+		{
+			const std::string dest = bakedTexturePath(source);
+			const bool converted = convertTexture(source, dest, compressBakedTextures);
+			std::cout << (converted ? "Baked " : "Failed to bake ") << source << " into " << dest << '\n';
+			success = success && converted;
+		}
+		return success ? 0 : 1;
+	}
+
+	if (benchmark && headlessPlatform == "null")
+	{
+		// Has to be set before glfwInit. The null platform has no real windows and can only make OSMesa contexts.
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+	}
+	if (!glfwInit())
+	{
+		std::cout << "Failed to initialize GLFW\n";
+		return -1;
+	}
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	if (benchmark)
+	{
+		// OSMesa renders on the CPU into an offscreen buffer, so nothing needs a display or a GPU driver.
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
 
 	GLFWwindow* window = glfwCreateWindow(800, 600, "LearnOpenGL", nullptr, nullptr);
 	if (window == nullptr)
@@ -49,10 +259,13 @@ int main()
 		glfwTerminate();
 		return -1;
 	}
-	// Capture mouse movement, force it to remain inside the window, and don't show the pointer.
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-	glfwSetCursorPosCallback(window, mouseCallback);
-	glfwSetScrollCallback(window, scrollCallback);
+	if (!benchmark)
+	{
+		// Capture mouse movement, force it to remain inside the window, and don't show the pointer.
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+		glfwSetCursorPosCallback(window, mouseCallback);
+		glfwSetScrollCallback(window, scrollCallback);
+	}
 	glfwMakeContextCurrent(window);
 
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -60,78 +273,493 @@ int main()
 		std::cout << "Failed to initialize GLAD\n";
 		return -1;
 	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
 	glViewport(0, 0, 800, 600);
 	glfwSetFramebufferSizeCallback(window, frameBufferSizeCallback); // Will resize the viewport as the window resizes
 
 	printNumberOfVertexAttributes();
 
-	Shader simpleShader("./Shaders/simpleVert.glsl", "./Shaders/simpleFrag.glsl");
+	// All programs are compiled together, and the driver works on them while we load everything else below.
+	// The instanced variant is the same source built with INSTANCED defined, which takes the model matrix from a vertex attribute.
+	ShaderManager shaders;
+	shaders.add("simple", "./Shaders/simpleVert.glsl", "./Shaders/simpleFrag.glsl");
+	shaders.add("simpleInstanced", "./Shaders/simpleVert.glsl", "./Shaders/simpleFrag.glsl", { "INSTANCED" });
+	if (useTextureArray)
+	{
+		shaders.add("simpleArray", "./Shaders/simpleVert.glsl", "./Shaders/simpleFrag.glsl", { "TEXTURE_ARRAY" });
+		shaders.add("simpleInstancedArray", "./Shaders/simpleVert.glsl", "./Shaders/simpleFrag.glsl", { "INSTANCED", "TEXTURE_ARRAY" });
+	}
+	shaders.compileAll();
+	CameraBlock cameraBlock;
+	cameraBlock.create();
+
+	// Textures decode on the worker threads and show up a frame or two later. Until then they sample as a flat grey placeholder.
+	ThreadPool threadPool;
+	TextureLoader textureLoader(threadPool);
+	// With --texture-array the same two images are packed up front instead. Both are 512x512, so they become two layers of one array.
+	GLuint tex0 = 0;
+	GLuint tex1 = 0;
+	MaterialAtlas materials(threadPool);
+	MaterialTexture containerMaterial;
+	MaterialTexture faceMaterial;
+	if (useTextureArray)
+	{
+		int container = materials.add(sceneTextures[0], GL_CLAMP_TO_EDGE);
+		int face = materials.add(sceneTextures[1], GL_REPEAT);
+		const bool built = materials.build();
+		containerMaterial = materials.get(container);
+		faceMaterial = materials.get(face);
+		// The frame binds one texture for both materials, so they have to have ended up in the same one.
+		if (!built || containerMaterial.texture != faceMaterial.texture)
+		{
+			std::cout << (built ? "The materials were packed into different textures" : "Failed to pack the materials")
+				<< ", loading the textures separately instead\n";
+			materials.destroy();
+			useTextureArray = false;
+		}
+	}
+	if (!useTextureArray)
+	{
+		TexturePolicy policy;
+		policy.minPSNR = textureBudget;
+		policy.mipFilter = useKaiserMips ? MipFilter::Kaiser : MipFilter::Box;
+		tex0 = textureLoader.load(useBakedTextures ? bakedTexturePath(sceneTextures[0]) : sceneTextures[0], GL_CLAMP, GL_CLAMP, GL_LINEAR, policy);
+		tex1 = textureLoader.load(useBakedTextures ? bakedTexturePath(sceneTextures[1]) : sceneTextures[1], GL_REPEAT, GL_REPEAT, GL_LINEAR, policy);
+	}
+
+	// Every mesh goes into one shared vertex/index buffer pair. Drawing a different mesh only changes the numbers in the draw call, never the VAO.
+	GeometryArena arena;
+	arena.create(64 * 1024, 192 * 1024);
+	MeshRange boxRange = arena.add(boxMesh());
+	std::vector<MeshRange> sceneMeshes = {
+		boxRange,
+		arena.add(triangleMesh()),
+		arena.add(rectangleMesh(1.f, 0.f)),
+		arena.add(twoTrianglesMesh()),
+		arena.add(triangleTwoMesh()),
+		arena.add(triangleWithTexCoordMesh())
+	};
+	GLuint VAO = arena.getVAO();
+
+	// The instanced path gets its own VAO over the same buffers. The per-instance attributes would otherwise stay enabled for the per-draw path too.
+	InstanceBuffer instanceBuffer;
+	GLuint instancedVAO = arena.createVAO();
+	instanceBuffer.attach(instancedVAO, 3);
 
-	GLuint tex0 = createTex("./Resources/container.jpg", GL_CLAMP, GL_CLAMP);
-	GLuint tex1 = createTex("./Resources/awesomeface.png", GL_REPEAT, GL_REPEAT);
-	GLuint VAO = getBoxVAO();
+	// Same idea for the multi-draw path. Its instance attribute is re-pointed per draw on GL 3.3, which must not leak into the instanced path.
+	MultiDrawBatch multiDraw;
+	multiDraw.attach(arena.createVAO(), 3);
+	for (const MeshRange& mesh : sceneMeshes)
+	{
+		multiDraw.addMesh(mesh);
+	}
+
+	// Per-frame dynamic data (the instance matrices for now) is carved out of this one buffer, with room for three frames in flight.
+	RingBuffer frameRing;
+	frameRing.create(cubeCount * sizeof(glm::mat4) + sceneMeshes.size() * sizeof(DrawElementsIndirectCommand) + 64 * 1024);
+	std::cout << "Frame ring buffer is " << (frameRing.isPersistent() ? "persistently mapped" : "mapped per allocation") << '\n';
 
 	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); Use this for wireframe
-	glEnable(GL_DEPTH_TEST);
+	glState.enable(GL_DEPTH_TEST);
+
+	shaders.finish();
+	Shader& simpleShader = *shaders.get(std::string(useInstancing || useMultiDraw ? "simpleInstanced" : "simple") + (useTextureArray ? "Array" : ""));
+	// Resolved once here, so setting them in the frame loop never touches a string or the allocator.
+	Uniform<int, hashName("tex")> texUniform(simpleShader);
+	Uniform<int, hashName("tex2")> tex2Uniform(simpleShader);
+	Uniform<int, hashName("texArray")> texArrayUniform(simpleShader);
+	Uniform<glm::vec4, hashName("texRect")> texRectUniform(simpleShader);
+	Uniform<glm::vec4, hashName("tex2Rect")> tex2RectUniform(simpleShader);
+	Uniform<glm::vec4, hashName("texLayers")> texLayersUniform(simpleShader);
+	Uniform<float, hashName("mixStrength")> mixStrengthUniform(simpleShader);
+	Uniform<glm::mat4, hashName("model")> modelUniform(simpleShader);
+
+	std::vector<glm::vec3> cubePositions = buildCubeField(cubeCount);
+	// Which of sceneMeshes each object in the field is drawn with. Only the multi-draw and per-draw paths can mix meshes.
+	std::vector<uint32_t> objectMeshes(cubePositions.size(), 0);
+	if (mixedMeshes)
+	{
+		for (size_t i = 0; i < objectMeshes.size(); i++)
+		{
+			objectMeshes[i] = (uint32_t)(i % sceneMeshes.size());
+		}
+	}
+	multiDraw.reserve(cubePositions.size());
+
+	// Static cubes get their transforms first and the rotating ones after, so update() never has to walk past the static ones.
+	// cubeTransforms maps a cube back to its transform.
+	const glm::vec3 cubeAxis = glm::normalize(glm::vec3(0.5f, 1.0f, 0.f));
+	TransformStore transforms;
+	transforms.reserve(cubePositions.size());
+	std::vector<TransformId> cubeTransforms(cubePositions.size());
+	std::vector<uint32_t> rotatingCubes;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (size_t i = 0; i < cubePositions.size(); i++)
+		{
+			bool rotating = cubeRotation((int)i) != 0.f;
+			if (rotating != (pass == 1)) continue;
+			cubeTransforms[i] = transforms.create(cubePositions[i]);
+			if (rotating) rotatingCubes.push_back((uint32_t)i);
+		}
+	}
 
-	glm::vec3 cubePositions[] = {
-		glm::vec3(0.0f,  0.0f,  0.0f),
-		glm::vec3(2.0f,  5.0f, -15.0f),
-		glm::vec3(-1.5f, -2.2f, -2.5f),
-		glm::vec3(-3.8f, -2.0f, -12.3f),
-		glm::vec3(2.4f, -0.4f, -3.5f),
-		glm::vec3(-1.7f,  3.0f, -7.5f),
-		glm::vec3(1.3f, -2.0f, -2.5f),
-		glm::vec3(1.5f,  2.0f, -2.5f),
-		glm::vec3(1.5f,  0.2f, -1.5f),
-		glm::vec3(-1.3f,  1.0f, -1.5f)
-	};
+	// The instanced path splits the field in two. Static cubes are uploaded once into a buffer of their own and drawn from it every
+	// frame with no CPU work, and only the rotating ones are culled, gathered and streamed through the ring. The other paths handle every cube per frame.
+	std::vector<uint32_t> perFrameCubes;
+	std::vector<glm::mat4> staticModels;
+	transforms.update();
+	for (size_t i = 0; i < cubePositions.size(); i++)
+	{
+		if (useInstancing && cubeRotation((int)i) == 0.f)
+		{
+			staticModels.push_back(transforms.getWorld(cubeTransforms[i]));
+		}
+		else
+		{
+			perFrameCubes.push_back((uint32_t)i);
+		}
+	}
+	InstanceBuffer staticInstances;
+	GLuint staticVAO = arena.createVAO();
+	staticInstances.attach(staticVAO, 3);
+	staticInstances.uploadStatic(staticModels);
+
+	// Every arena mesh fits in the unit box around its origin, and rotating doesn't move a sphere, so the bounds never change.
+	// Slot k is perFrameCubes[k].
+	SphereSet cubeBounds;
+	cubeBounds.resize(perFrameCubes.size());
+	for (size_t k = 0; k < perFrameCubes.size(); k++)
+	{
+		cubeBounds.set(k, cubePositions[perFrameCubes[k]], 0.8660254f); // Half the diagonal of a unit cube.
+	}
+	cubeBounds.build();
+	std::vector<uint32_t> visibleCubes;
+	CullStats cullStats;
+
+	// The hierarchy holds tight boxes instead of spheres. The rotating cubes' boxes change every frame and get refit, the others are built once.
+	const glm::vec3 cubeHalfExtents(0.5f);
+	BVH cubeTree;
+	if (useSpatialIndex)
+	{
+		std::vector<AABB> cubeBoxes(cubePositions.size());
+		for (size_t i = 0; i < cubePositions.size(); i++)
+		{
+			cubeBoxes[i] = transformedBox(t(cubePositions[i]), cubeHalfExtents);
+		}
+		cubeTree.build(cubeBoxes);
+	}
+	bool pickHeld = false;
+	std::vector<uint32_t> nearbyCubes;
+	std::vector<glm::mat4> models;
+	models.reserve(cubePositions.size());
+	RenderQueue renderQueue;
+	renderQueue.reserve(cubePositions.size());
+	SortKeyIds programIds;
+	SortKeyIds textureSetIds;
+	SortKeyIds vaoIds;
+
+	// A few chunks per worker, so a worker that finishes early can pick up another one.
+	const size_t cubesPerChunk = 1024;
+	std::vector<CommandList> commandLists((cubePositions.size() + cubesPerChunk - 1) / cubesPerChunk);
+	for (CommandList& list : commandLists)
+	{
+		list.reserve(cubesPerChunk * 2 + 4, cubesPerChunk);
+	}
+	std::cout << "Drawing " << cubePositions.size() << " cubes " << (useInstancing ? "instanced, " + std::to_string(staticModels.size()) + " of them static" : useMultiDraw ? (glExt.multiDrawIndirect ? "with one multi-draw indirect call" : "with one instanced draw per mesh") : useThreadedRecording ? "from command lists recorded on worker threads" : "with one draw call each") << '\n';
+
+	BenchmarkRecorder recorder;
+	if (benchmark)
+	{
+		recorder.create(benchmarkFrames);
+		textureLoader.finish(); // Textures arriving on different frames would make runs incomparable.
+		std::cout << "Benchmarking " << benchmarkFrames << " frames\n";
+	}
 
 	float mixStrength = 0.5;
-	while (!glfwWindowShouldClose(window))
+	int frame = 0;
+	while (benchmark ? frame < benchmarkFrames : !glfwWindowShouldClose(window))
 	{
-		float time = (float)glfwGetTime();
+		// The benchmark derives time from the frame number instead of the clock, which keeps every frame reproducible between runs.
+		float time = benchmark ? frame * fixedTimeStep : (float)glfwGetTime();
 		deltaTime = time - lastFrame;
 		lastFrame = time;
 
-		processInput(window, mixStrength, deltaTime);
+		glState.resetCounters();
+		frameRing.beginFrame();
+		if (benchmark)
+		{
+			recorder.beginFrame(frame);
+		}
+		else
+		{
+			processInput(window, mixStrength, deltaTime);
+		}
+		textureLoader.update();
 		glClearColor(0.3f, 0.2f, 0.2f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 		glClear(GL_DEPTH_BUFFER_BIT);
 		glClear(GL_STENCIL_BUFFER_BIT);
 
+		cameraBlock.update(camera); // view/proj live in a uniform buffer shared by every program, and it's only written when the camera changed.
 		simpleShader.use(); // Every shader and rendering call after this will use the program with our linked vertex/frag shader
-		simpleShader.setInt("tex", 0); // I think this is saying "the sampler called tex will sample from texture unit (or location 0)". We then bind our texture to that location below.
-		simpleShader.setInt("tex2", 1);
-		simpleShader.setFloat("mixStrength", mixStrength);
-		simpleShader.setMatrix4("view", camera.getView());
-		simpleShader.setMatrix4("proj", camera.getProj());
+		texUniform.set(0); // I think this is saying "the sampler called tex will sample from texture unit (or location 0)". We then bind our texture to that location below.
+		tex2Uniform.set(1); // The shader remembers what it last sent, so re-setting these every frame doesn't reach the driver.
+		mixStrengthUniform.set(mixStrength);
 
-		glActiveTexture(GL_TEXTURE0); // This activates "texture unit 0". The next line will bind the texture to that unit. tex unit is the location from which a sampler will sample. This is how we can get multiple textures.
-		glBindTexture(GL_TEXTURE_2D, tex0);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, tex1);
-		glBindVertexArray(VAO);
+		// This activates "texture unit 0" and binds the texture to that unit. tex unit is the location from which a sampler will sample. This is how we can get multiple textures.
+		// glState drops the calls when the texture is already sitting on that unit from last frame.
+		if (useTextureArray)
+		{
+			// One bind covers both materials. The rects and layers tell the shader where each one is.
+			texArrayUniform.set(0);
+			texRectUniform.set(containerMaterial.rect);
+			tex2RectUniform.set(faceMaterial.rect);
+			texLayersUniform.set(glm::vec4((float)containerMaterial.layer, (float)faceMaterial.layer, containerMaterial.repeat ? 1.f : 0.f, faceMaterial.repeat ? 1.f : 0.f));
+			glState.bindTextureUnit(0, GL_TEXTURE_2D_ARRAY, containerMaterial.texture);
+		}
+		else
+		{
+			glState.bindTextureUnit(0, GL_TEXTURE_2D, tex0);
+			glState.bindTextureUnit(1, GL_TEXTURE_2D, tex1);
+		}
+		// Only the rotating cubes are touched. Everything else keeps the world matrix it got on the first update.
+		for (uint32_t i : rotatingCubes)
+		{
+			transforms.setRotation(cubeTransforms[i], glm::angleAxis(time * cubeRotation((int)i), cubeAxis));
+		}
+		transforms.update();
 
-		for (auto i = 0; i < 10; i++)
+		// Only bring the tree up to date when something is about to query it. With --no-cull that is just a P press.
+		auto refitCubeTree = [&]
+		{
+			for (uint32_t i : rotatingCubes)
+			{
+				cubeTree.update(i, transformedBox(transforms.getWorld(cubeTransforms[i]), cubeHalfExtents));
+			}
+			cubeTree.refit();
+		};
+		if (useSpatialIndex && useCulling)
+		{
+			refitCubeTree();
+		}
+		if (useSpatialIndex && !benchmark)
+		{
+			bool pickDown = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+			if (pickDown && !pickHeld)
+			{
+				if (!useCulling)
+				{
+					refitCubeTree();
+				}
+				uint32_t hitCube = 0;
+				float hitDistance = 0.f;
+				if (cubeTree.queryRay(camera.getPosition(), camera.getFront(), camera.getFarClip(), hitCube, hitDistance))
+				{
+					std::cout << "Looking at cube " << hitCube << ", " << hitDistance << " units away. ";
+				}
+				nearbyCubes.clear();
+				cubeTree.queryRadius(camera.getPosition(), 5.f, nearbyCubes);
+				std::cout << nearbyCubes.size() << " cubes within 5 units\n";
+			}
+			pickHeld = pickDown;
+		}
+
+		// Only the per-frame cubes that survive culling go to the draw paths below, whatever path is used.
+		if (useCulling && useSpatialIndex)
+		{
+			visibleCubes.clear();
+			cubeTree.queryFrustum(extractFrustum(camera.getProj() * camera.getView()), visibleCubes);
+			if (!staticModels.empty())
+			{
+				// The tree holds the static cubes too, but those are already drawn from their own buffer.
+				size_t kept = 0;
+				for (uint32_t i : visibleCubes)
+				{
+					if (cubeRotation((int)i) != 0.f) visibleCubes[kept++] = i;
+				}
+				visibleCubes.resize(kept);
+			}
+			cullStats.visible = (unsigned int)visibleCubes.size();
+			cullStats.culled = (unsigned int)(perFrameCubes.size() - visibleCubes.size());
+		}
+		else if (useCulling)
+		{
+			cullStats = cullSpheres(extractFrustum(camera.getProj() * camera.getView()), cubeBounds, visibleCubes);
+			for (uint32_t& i : visibleCubes)
+			{
+				i = perFrameCubes[i];
+			}
+		}
+		else if (visibleCubes.size() != perFrameCubes.size())
+		{
+			visibleCubes = perFrameCubes;
+			cullStats.visible = (unsigned int)visibleCubes.size();
+			cullStats.culled = 0;
+		}
+
+		if (useInstancing)
+		{
+			if (!staticModels.empty())
+			{
+				glState.bindVertexArray(staticVAO);
+				drawMeshInstanced(boxRange, (GLsizei)staticModels.size());
+			}
+
+			models.clear();
+			for (uint32_t i : visibleCubes)
+			{
+				models.push_back(transforms.getWorld(cubeTransforms[i]));
+			}
+			if (!models.empty() && instanceBuffer.upload(frameRing, models))
+			{
+				glState.bindVertexArray(instancedVAO);
+				drawMeshInstanced(boxRange, (GLsizei)models.size());
+			}
+		}
+		else if (useMultiDraw)
 		{
-			float rotate = i % 3 == 0 ? i + 1 : 0;
-			glm::mat4 model = tr(cubePositions[i], glm::vec3(0.5f, 1.0f, 0.f), (float)glfwGetTime() * rotate * glm::radians(-55.0f));
-			simpleShader.setMatrix4("model", model);
-			glDrawArrays(GL_TRIANGLES, 0, 36);
+			multiDraw.clear();
+			for (uint32_t i : visibleCubes)
+			{
+				multiDraw.add(objectMeshes[i], transforms.getWorld(cubeTransforms[i]));
+			}
+			multiDraw.submit(frameRing);
+		}
+		else if (useThreadedRecording)
+		{
+			// Each chunk of the field is recorded into its own list in parallel. Building matrices is the expensive part and it happens off the GL thread.
+			// Replaying the lists in chunk order keeps the result identical from run to run, however the chunks were scheduled.
+			const size_t chunkCount = (visibleCubes.size() + cubesPerChunk - 1) / cubesPerChunk;
+			threadPool.parallelFor(chunkCount, [&](size_t chunk)
+			{
+				CommandList& list = commandLists[chunk];
+				list.clear();
+				list.useProgram(simpleShader);
+				list.bindVertexArray(VAO);
+				if (!useTextureArray)
+				{
+					list.bindTexture(0, tex0);
+					list.bindTexture(1, tex1);
+				}
+				size_t end = (chunk + 1) * cubesPerChunk < visibleCubes.size() ? (chunk + 1) * cubesPerChunk : visibleCubes.size();
+				for (size_t k = chunk * cubesPerChunk; k < end; k++)
+				{
+					uint32_t i = visibleCubes[k];
+					list.setUniform(modelUniform, transforms.getWorld(cubeTransforms[i]));
+					list.drawMesh(boxRange);
+				}
+			});
+			for (size_t chunk = 0; chunk < chunkCount; chunk++)
+			{
+				commandLists[chunk].replay();
+			}
+		}
+		else
+		{
+			// Each cube becomes a packet with a sort key, and the queue puts them in state order, nearest first, before anything is drawn.
+			// With one program, one texture pair and one VAO that boils down to front-to-back order.
+			models.clear();
+			renderQueue.clear();
+			glm::mat4 view = camera.getView();
+			// Every cube shares this state today. A scene with more materials would look up its ids per packet the same way.
+			const uint32_t programId = programIds.get(simpleShader.id);
+			const uint32_t textureSetId = textureSetIds.get(((uint64_t)tex0 << 32) | tex1);
+			const uint32_t vaoId = vaoIds.get(VAO);
+			for (uint32_t i : visibleCubes)
+			{
+				models.push_back(transforms.getWorld(cubeTransforms[i]));
+				float depth = -(view * glm::vec4(cubePositions[i], 1.f)).z / camera.getFarClip();
+
+				DrawPacket packet;
+				packet.key = makeSortKey(programId, textureSetId, vaoId, depth);
+				packet.program = simpleShader.id;
+				packet.vao = VAO;
+				packet.textures[0] = tex0;
+				packet.textures[1] = tex1;
+				packet.mesh = sceneMeshes[objectMeshes[i]];
+				packet.transformIndex = (uint32_t)models.size() - 1;
+				renderQueue.push(packet);
+			}
+			renderQueue.sort();
+			renderQueue.execute([&](const DrawPacket& packet)
+			{
+				modelUniform.set(models[packet.transformIndex]);
+			});
 		}
 		//glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+		frameRing.endFrame();
+
+		if (benchmark)
+		{
+			recorder.endFrame(glState.getCounters(), cullStats);
+		}
+		frame++;
 
 		glfwSwapBuffers(window); // Swaps color buffer for window and shows it as output to the screen. Front buffer is the output image, back buffer is where commands go.
 
 		glfwPollEvents(); // Checks if inputs events are triggered and updates window state
 	}
 
+	if (benchmark)
+	{
+		recorder.finish();
+		recorder.write(benchmarkOut);
+		recorder.printSummary();
+		recorder.destroy();
+	}
+
+	staticInstances.destroy();
+	materials.destroy();
+	frameRing.destroy();
+	arena.destroy();
+	cameraBlock.destroy();
+	textureLoader.finish();
+	textureLoader.printMemoryReport();
+	textureLoader.destroy();
+	shaders.destroy();
 	glfwTerminate();
 	return 0;
 }
 
+// The first ten cubes are the ones from the tutorial. Anything past that is laid out on a grid further down -Z.
+std::vector<glm::vec3> buildCubeField(int count)
+{
+	std::vector<glm::vec3> positions = {
+		glm::vec3(0.0f,  0.0f,  0.0f),
+		glm::vec3(2.0f,  5.0f, -15.0f),
+		glm::vec3(-1.5f, -2.2f, -2.5f),
+		glm::vec3(-3.8f, -2.0f, -12.3f),
+		glm::vec3(2.4f, -0.4f, -3.5f),
+		glm::vec3(-1.7f,  3.0f, -7.5f),
+		glm::vec3(1.3f, -2.0f, -2.5f),
+		glm::vec3(1.5f,  2.0f, -2.5f),
+		glm::vec3(1.5f,  0.2f, -1.5f),
+		glm::vec3(-1.3f,  1.0f, -1.5f)
+	};
+	positions.resize(count < (int)positions.size() ? count : positions.size());
+
+	const int extra = count - (int)positions.size();
+	const int side = (int)std::ceil(std::cbrt((float)(extra > 0 ? extra : 0)));
+	for (int i = 0; i < extra; i++)
+	{
+		int x = i % side;
+		int y = (i / side) % side;
+		int z = i / (side * side);
+		positions.push_back(glm::vec3((x - side / 2) * 2.f, (y - side / 2) * 2.f, -20.f - z * 2.f));
+	}
+
+	return positions;
+}
+
+// Every third cube spins, and the later ones spin faster. The rest stay put.
+float cubeRotation(int index)
+{
+	float rotate = index % 3 == 0 ? index % 10 + 1 : 0;
+	return rotate * glm::radians(-55.0f);
+}
+
 void frameBufferSizeCallback(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
@@ -183,308 +811,3 @@ void scrollCallback(GLFWwindow* window, double xOffset, double yOffset)
 {
 	camera.zoom(-yOffset);
 }
-
-// Usually when you have multiple objects, you first generatte/configure all the VAOs (attribute pointers + VBOs) then store for later use.
-// When using a VBO like this, we call glDrawArrays
-GLuint getTriangleVAO()
-{
-	float vertices[] = {
-		-0.5f, -0.5f, 0.0f,
-		 0.5f, -0.5f, 0.0f,
-		 0.0f,  0.5f, 0.0f
-	};
-
-	// This is a general pattern in OpenGL. Has a concept of Objects. Object is a collection of options that repesent a subset of OpenGL's state.
-	// Can visualize them as a C-like struct.
-	// Ask OpenGL to create the object and give you an ID you can use to access it
-	// Bind the object to part of the GL context's state.
-	// Set options on the object
-	// I'm thinking these objects remain allocated under the hood. Unbinding them just removes them from context state. Looks like they may have to be destroyed explicitly to be relasesd
-	GLuint VBO; // vertex buffer object, used to manage which vertices we've sent to the GPU
-	glGenBuffers(1, &VBO); // first argument is the number of buffers to generate, second argument is an array of ids. Buffers are instatiated behind the scenes
-
-	// VAO - Vertex Array Object. Benefit is that when configuring attribute pointers, we can store that info in the VAO. Then just
-// rebind the VAO when we need to draw the object again, instead of repeating the above every time for different objects. Makes it easier to switch
-// between different vertex data and attribute configurations.
-// OpenGL Core REQUIRES a VAO
-// only needs to be done once
-	GLuint VAO;
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO); // Can bind several buffers at once if they have separate types. This is the buffer type of a vertex buffer
-
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW); // Allocates memory and stores data in the buffer bound to the target
-
-	/* usage arg tells the graphics card how we want it to manage the given data. Sounds like it may determine what kind of memory the buffer goes into
-	 *GL_STREAM_DRAW: the data is set only once and used by the GPU at most a few times.
-GL_STATIC_DRAW: the data is set only once and used many times.
-GL_DYNAMIC_DRAW: the data is changed a lot and used many times.
-*/
-	// We need to specify which part of input data goes to which vertex attribute.
-	// Remember that in the shader, we spcifed location of position attribute at 0.
-	// So this essentially says "the shader position input has a size of 3 (3 values), the positions are floats, they aren't normalized between 0 and 1,
-	// each position is 12 bytes apart in the input data. (Since the values are tightly packed, we technically could pass 0 for the stride and openGL would figure it out)
-	// Each vertex attribute takes memory from a VBO. The VBO used is what we've currently bound to GL_ARRAY_BUFFER
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-	// This enabled the vertex attribute we just described to OpenGL in the previous line. Attributes are disabled by default.
-	glEnableVertexAttribArray(0);
-
-	// This is safe to do. glVertexAttribPoiunter registered the VBO as the bound buffer object.
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	// We typically don't call this, because modifying other VAOs required binding to them.
-	// NOTE: Worth remembering that I hadn't bound the VAO in here before, which led to a bug where the triangle would be drawn.
-	// I'm guessing this is because OpenGL didn't link the buffer or vertex attribute pointer to the VAO, since it wasn't "active".
-	glBindVertexArray(0);
-
-	return VAO;
-}
-
-// WHen we draw with an element buffer,we call glDrawElements
-GLuint getRectangleVAO(float texScale, float offset)
-{
-	float vertices[] = {
-		// positions          // colors           // texture coords
-		 0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   texScale + offset, texScale + offset,   // top right
-		 0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   texScale + offset, offset,   // bottom right
-		-0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   offset, offset,   // bottom left
-		-0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   offset, texScale + offset    // top left 
-	};
-
-	unsigned int indices[]
-	{
-		0, 1, 2,
-		0, 2, 3
-	};
-
-	GLuint VAO;
-	glGenVertexArrays(1, &VAO);
-	GLuint VBO;
-	glGenBuffers(1, &VBO);
-
-	// Think of EBO as an index buffer, so we don't have redundant vertices in this example of a rectangle
-	GLuint EBO;
-	glGenBuffers(1, &EBO);
-
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)nullptr);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-
-	// VERY IMPORTANT. YOU NEED TO UNBIND VAO FIRST. The vao records the bind buffer calls. Which means if we unbind the others first, they end up unbound in the VAO
-	// Last element buffer bound while the VAO is bound will be rebound when the VAO is rebound
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-	return VAO;
-}
-
-// Exercise called for VAO, so that's why we're doing it.
-GLuint getTwoTrianglesVAO()
-{
-	float vertices[] = {
-		-0.5, -0.5, 0, // bot left
-		-0.5, 0.5, 0, // up left
-		0.5, 0.5, 0, // up right
-		-0.5, -0.5, 0, // bot left
-		0.5, 0.5, 0, // up right
-		0.5, -0.5, 0 //bot right 
-	};
-
-	GLuint VAO;
-	glGenVertexArrays(1, &VAO);
-	GLuint VBO;
-	glGenBuffers(1, &VBO);
-
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)nullptr);
-	glEnableVertexAttribArray(0);
-
-	// VERY IMPORTANT. YOU NEED TO UNBIND VAO FIRST. The vao records the bind buffer calls. Which means if we unbind the others first, they end up unbound in the VAO
-	// Last element buffer bound while the VAO is bound will be rebound when the VAO is rebound
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	return VAO;
-}
-
-GLuint getTriangleTwoVAO()
-{
-	float vertices[] = {
-		-0.5, -0.5, 0,
-		0.5, 0.5, 0,
-		0.5, -0.5, 0
-	};
-
-	GLuint VAO;
-	glGenVertexArrays(1, &VAO);
-	GLuint VBO;
-	glGenBuffers(1, &VBO);
-
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)nullptr);
-	glEnableVertexAttribArray(0);
-
-	glBindVertexArray(0);
-	glEnableVertexAttribArray(0);
-
-	return VAO;
-}
-
-// Without using a texture, this produces a rainbow effect because the output color from the vertex is interpolated between the verts based on
-// fragment position.
-GLuint getTriangleVAOWithTexCoord()
-{
-	// First 3 of each row are positions, second 3 of each row are colors, third two are tex coords
-	// The stride is now 32 for everything, 12 for each attribute.
-	float vertices[] = {
-	-0.5f, -0.5f, 0.0f, 1.f, 0.f, 0.f, 0.f, 0.f,
-	 0.5f, -0.5f, 0.0f, 0.f, 1.f, 0.f, 1.f, 0.f,
-	 0.0f,  0.5f, 0.0f, 0.f, 0.f, 1.f, 0.5f, 1.f
-	};
-
-	GLuint VBO;
-	glGenBuffers(1, &VBO);
-	
-	GLuint VAO;
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	// Position attribute
-	// Size appears to be the number of components. The stride is the stride for an ENTIRE VERTEX.
-	// The last argument gives the offset of the attribute within a single vertex
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)nullptr);
-	glEnableVertexAttribArray(0);
-	// Color attribute
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	// tex coord attribute
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	glBindVertexArray(0);
-
-	return VAO;
-}
-
-GLuint getBoxVAO()
-{
-	float vertices[] = {
-	   -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-		0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-		0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-		0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-	   -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-	   -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-
-	   -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-		0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-		0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-		0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-	   -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-	   -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-
-	   -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-	   -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-	   -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-	   -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-	   -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-	   -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-		0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-		0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-		0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-		0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-		0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-		0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-	   -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-		0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-		0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-		0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-	   -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-	   -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-
-	   -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-		0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-		0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-		0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-	   -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-	   -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
-	};
-
-	GLuint vao = 0;
-	glGenVertexArrays(1, &vao);
-	GLuint vbo = 0;
-	glGenBuffers(1, &vbo);
-
-	glBindVertexArray(vao);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)nullptr);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	return vao;
-}
-
-GLuint createTex(const char* texPath, int sWrap, int tWrap, int magFilter)
-{
-	stbi_set_flip_vertically_on_load(true); // For STBI, y == 0 is at the top. For OpenGL, y == 0 is at the bottom.
-
-	GLuint texture = 0;
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sWrap); // Repeat horizontally if s (think UVs) is less than zero or greater than one. Could also clamp here.
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, tWrap);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // When the texture takes up a small enough portion of the screen, (i.e. minification) use mipmaps. Linear filtering between mipmap levels and linear filtering between texels.
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter); // When the texture is scaled larger, use linear filtering on texels.
-
-	int width, height, numChannels;
-	unsigned char* data = stbi_load(texPath, &width, &height, &numChannels, 0);
-	GLenum fmt = GL_NONE;
-	if (numChannels == 3)
-	{
-		fmt = GL_RGB;
-	}
-	else if (numChannels == 4)
-	{
-		fmt = GL_RGBA;
-	}
-
-
-	if (data != nullptr)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, fmt, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture from " << texPath << '\n';
-	}
-	stbi_image_free(data);
-	data = nullptr;
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	return texture;
-}
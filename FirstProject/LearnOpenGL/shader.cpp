@@ -1,6 +1,11 @@
 #include "shader.h"
-
-bool checkCompilationStatus(GLuint shaderId, const std::string& path);
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include "CameraBlock.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "ProgramCache.h"
 
 Shader::Shader(const char* vertPath, const char* fragPath)
 {
@@ -10,6 +15,16 @@ Shader::Shader(const char* vertPath, const char* fragPath)
 	std::string fragSrc;
 	if (!readFile(vertPath, vertSrc) || !readFile(fragPath, fragSrc)) return;
 
+	// A binary saved by an earlier run with the same sources and driver skips compiling and linking entirely.
+	uint64_t cacheKey = programCacheKey(vertSrc, fragSrc);
+	GLuint cached = loadCachedProgram(cacheKey);
+	if (cached != 0)
+	{
+		id = cached;
+		reflectUniforms();
+		return;
+	}
+
 	const char* vertCStr = vertSrc.c_str();
 	const char* fragCStr = fragSrc.c_str();
 
@@ -26,6 +41,10 @@ Shader::Shader(const char* vertPath, const char* fragPath)
 	GLuint program = glCreateProgram();
 	glAttachShader(program, vert);
 	glAttachShader(program, frag);
+	if (glExt.programBinary)
+	{
+		glExt.programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); // Must be set before linking for the binary to be retrievable.
+	}
 	glLinkProgram(program);
 
 	int success = 0;
@@ -42,35 +61,146 @@ Shader::Shader(const char* vertPath, const char* fragPath)
 	glDeleteShader(frag);
 
 	id = program;
+	saveCachedProgram(cacheKey, program);
+	reflectUniforms();
+}
+
+Shader::Shader(GLuint linkedProgram)
+{
+	id = linkedProgram;
+	if (id != 0)
+	{
+		reflectUniforms();
+	}
 }
 
 void Shader::use() const
 {
-	glUseProgram(id);
+	glState.useProgram(id);
+}
+
+void Shader::setBool(const char* name, bool value) const
+{
+	write(findUniform(fnv1a(name, strlen(name))), value);
+}
+
+void Shader::setInt(const char* name, int value) const
+{
+	write(findUniform(fnv1a(name, strlen(name))), value);
+}
+
+void Shader::setFloat(const char* name, float value) const
+{
+	write(findUniform(fnv1a(name, strlen(name))), value);
+}
+
+void Shader::setVec4(const char* name, const glm::vec4& value) const
+{
+	write(findUniform(fnv1a(name, strlen(name))), value);
+}
+
+void Shader::setMatrix4(const char* name, const glm::mat4& mat) const
+{
+	write(findUniform(fnv1a(name, strlen(name))), mat);
 }
 
-void Shader::setBool(const std::string& name, bool value) const
+// Returns -1 for names the program doesn't use. Setting those is a no-op, like glUniform* with location -1.
+int Shader::findUniform(uint64_t nameHash) const
 {
-	GLint location = glGetUniformLocation(id, name.c_str());
-	glUniform1i(location, (int)value);
+	auto it = std::lower_bound(uniformIndices.begin(), uniformIndices.end(), std::make_pair(nameHash, INT_MIN));
+	return it != uniformIndices.end() && it->first == nameHash ? it->second : -1;
 }
 
-void Shader::setInt(const std::string& name, int value) const
+void Shader::write(int index, bool value) const
 {
-	GLint location = glGetUniformLocation(id, name.c_str());
-	glUniform1i(location, value);
+	write(index, (int)value);
 }
 
-void Shader::setFloat(const std::string& name, float value) const
+void Shader::write(int index, int value) const
 {
-	GLint location = glGetUniformLocation(id, name.c_str());
-	glUniform1f(location, value);
+	if (!changeUniform(index, &value, sizeof(value))) return;
+	glUniform1i(uniforms[index].location, value);
 }
 
-void Shader::setMatrix4(const std::string& name, glm::mat4 mat) const
+void Shader::write(int index, float value) const
 {
-	GLint location = glGetUniformLocation(id, name.c_str());
-	glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
+	if (!changeUniform(index, &value, sizeof(value))) return;
+	glUniform1f(uniforms[index].location, value);
+}
+
+void Shader::write(int index, const glm::vec4& value) const
+{
+	if (!changeUniform(index, glm::value_ptr(value), sizeof(value))) return;
+	glUniform4fv(uniforms[index].location, 1, glm::value_ptr(value));
+}
+
+void Shader::write(int index, const glm::mat4& mat) const
+{
+	if (!changeUniform(index, glm::value_ptr(mat), sizeof(mat))) return;
+	glUniformMatrix4fv(uniforms[index].location, 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+// Asks the linked program which uniforms survived compilation instead of looking each one up by name every time it's set.
+// Uniforms that live in a block (like the camera block) have no location and are left out.
+void Shader::reflectUniforms()
+{
+	uniformIndices.clear();
+	uniforms.clear();
+
+	GLint count = 0;
+	glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+	GLint maxLength = 0;
+	glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	std::vector<char> nameBuffer(maxLength > 0 ? maxLength : 1);
+
+	for (GLint i = 0; i < count; i++)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = GL_NONE;
+		glGetActiveUniform(id, (GLuint)i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+		GLint location = glGetUniformLocation(id, nameBuffer.data());
+		if (location < 0) continue;
+
+		UniformSlot slot;
+		slot.location = location;
+		slot.type = type;
+		int index = (int)uniforms.size();
+		uniformIndices.push_back(std::make_pair(fnv1a(nameBuffer.data(), length), index));
+		// Arrays are reported as "name[0]". Let them be set through the plain name too, like glGetUniformLocation allows.
+		const char* bracket = strchr(nameBuffer.data(), '[');
+		if (bracket != nullptr)
+		{
+			uniformIndices.push_back(std::make_pair(fnv1a(nameBuffer.data(), bracket - nameBuffer.data()), index));
+		}
+		uniforms.push_back(slot);
+	}
+
+	std::sort(uniformIndices.begin(), uniformIndices.end());
+	for (size_t i = 1; i < uniformIndices.size(); i++)
+	{
+		if (uniformIndices[i].first == uniformIndices[i - 1].first && uniformIndices[i].second != uniformIndices[i - 1].second)
+		{
+			std::cout << "Two uniforms in program " << id << " hash to the same name. Only one of them can be set.\n";
+		}
+	}
+
+	GLuint blockIndex = glGetUniformBlockIndex(id, cameraBlockName);
+	if (blockIndex != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(id, blockIndex, cameraBlockBinding);
+	}
+}
+
+// Returns false when the slot already holds this exact value, so the caller can skip the glUniform call.
+bool Shader::changeUniform(int index, const void* value, size_t size) const
+{
+	if (index < 0) return false;
+	UniformSlot& slot = uniforms[index];
+	if (slot.hasValue && memcmp(slot.value, value, size) == 0) return false;
+	memcpy(slot.value, value, size);
+	slot.hasValue = true;
+	return true;
 }
 
 bool checkCompilationStatus(GLuint shaderId, const std::string& path)
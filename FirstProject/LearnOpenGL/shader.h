@@ -1,22 +1,89 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 #include <glad/glad.h>
 #include <iostream>
 #include "helpers.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+bool checkCompilationStatus(GLuint shaderId, const std::string& path);
+
 class Shader
 {
 public:
 	unsigned int id;
 
 	Shader(const char* vertexPath, const char* fragmentPath);
+	// Wraps a program that was already linked somewhere else, like the ShaderManager. It stays owned there, this doesn't delete it. 0 makes an empty shader.
+	explicit Shader(GLuint linkedProgram);
 
 	void use() const;
-	void setBool(const std::string& name, bool value) const;
-	void setInt(const std::string& name, int value) const;
-	void setFloat(const std::string& name, float value) const;
-	void setMatrix4(const std::string& name, glm::mat4 mat) const;
-};
\ No newline at end of file
+	// These hash the name on every call. In hot loops, prefer a Uniform handle, which looks the name up once.
+	void setBool(const char* name, bool value) const;
+	void setInt(const char* name, int value) const;
+	void setFloat(const char* name, float value) const;
+	void setVec4(const char* name, const glm::vec4& value) const;
+	void setMatrix4(const char* name, const glm::mat4& mat) const;
+
+	// Index of the uniform whose name hashes to nameHash, or -1 if the program doesn't use it.
+	int findUniform(uint64_t nameHash) const;
+
+private:
+	template<typename T, uint64_t NameHash> friend class Uniform;
+	friend class CommandList;
+
+	// One entry per active uniform, filled in once after linking. The last value we sent is kept so repeated sets of the same value never reach the driver.
+	struct UniformSlot
+	{
+		GLint location = -1;
+		GLenum type = GL_NONE;
+		bool hasValue = false;
+		float value[16] = {};
+	};
+
+	void reflectUniforms();
+	bool changeUniform(int index, const void* value, size_t size) const;
+	void write(int index, bool value) const;
+	void write(int index, int value) const;
+	void write(int index, float value) const;
+	void write(int index, const glm::vec4& value) const;
+	void write(int index, const glm::mat4& mat) const;
+
+	// Sorted by hash so lookups are a binary search over plain integers, with no strings involved.
+	std::vector<std::pair<uint64_t, int>> uniformIndices;
+	mutable std::vector<UniformSlot> uniforms;
+};
+
+// A typed handle to one uniform of one shader. The name is hashed at compile time and resolved to a slot once, when the handle is made,
+// so set() does no string work and never allocates. The shader must outlive the handle.
+//	Uniform<glm::mat4, hashName("model")> model(shader);
+//	model.set(matrix);
+template<typename T, uint64_t NameHash>
+class Uniform
+{
+public:
+	explicit Uniform(const Shader& shader)
+		: shader(&shader), index(shader.findUniform(NameHash))
+	{
+	}
+
+	void set(const T& value) const
+	{
+		shader->write(index, value);
+	}
+
+	bool exists() const
+	{
+		return index >= 0;
+	}
+
+private:
+	friend class CommandList;
+
+	const Shader* shader;
+	int index;
+};